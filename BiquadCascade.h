@@ -0,0 +1,503 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "FilterDesign.h"
+#include "InterleavedLanes.h"
+
+#if JUCE_USE_SIMD && (defined (__SSE2__) || defined (_M_X64) || defined (_M_AMD64) || (defined (_M_IX86_FP) && _M_IX86_FP >= 2))
+ #define PFILTER_PIPELINE_SSE 1
+#elif JUCE_USE_SIMD && (defined (__ARM_NEON__) || defined (__ARM_NEON))
+ #define PFILTER_PIPELINE_NEON 1
+#endif
+
+// Cascade of transposed direct form II biquads that runs several channels at once,
+// one channel per SIMD lane (SSE/AVX on x86, NEON on ARM, via juce::dsp::SIMDRegister).
+// Channels are interleaved into aligned scratch (InterleavedLanes) so that each stage advances
+// every lane with one register operation, with the filter state held in aligned lanes.
+//
+// With three or four stages on a four-lane register, and at most two channels (so the
+// packed layout would leave half the lanes idle), the cascade switches to a pipelined
+// layout instead: one channel at a time, stage k in lane k, each stage working one
+// sample behind the previous one so all stages advance in the same instruction rather
+// than waiting on each other's recursion. The pipeline is filled and drained inside
+// every block, so it adds no latency. Each section performs exactly the same operations
+// as the lane-packed path, so a null test between the two is bit-exact unless the
+// compiler contracts them into FMAs, in which case the residual stays below 1e-6
+// relative to full scale (about -120 dB).
+//
+// Every stage count and SectionForm has its own kernel, instantiated at compile time and
+// picked from a table once per block: the stages of the lane-packed path are unrolled
+// into one pass over the samples with their state in registers, and the known numerator
+// shape drops the high-pass/low-pass/notch sections from five multiplies to three.
+template <typename SampleType>
+class BiquadCascade
+{
+public:
+    using Vec = juce::dsp::SIMDRegister<SampleType>;
+
+    static constexpr int maxStages = CoefficientSnapshot::maxStages;
+    static constexpr int lanes = static_cast<int>(Vec::SIMDNumElements);
+
+    void prepare(int maximumBlockSize, int maximumChannels)
+    {
+        numChannelsPrepared = juce::jmax(1, maximumChannels);
+        numGroups = (numChannelsPrepared + lanes - 1) / lanes;
+
+        scratch.prepare(maximumBlockSize);
+        state.resize(static_cast<size_t>(numGroups * maxStages));
+        pipelineState.resize(static_cast<size_t>(numGroups * lanes));
+
+        for (int lane = 0; lane < lanes; ++lane)
+            laneIndex.set(static_cast<size_t>(lane), static_cast<SampleType>(lane));
+
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        for (auto& s : state)
+        {
+            s.s1 = Vec::expand(SampleType(0));
+            s.s2 = Vec::expand(SampleType(0));
+        }
+
+        for (auto& s : pipelineState)
+        {
+            s.s1 = Vec::expand(SampleType(0));
+            s.s2 = Vec::expand(SampleType(0));
+        }
+    }
+
+    // The two layouts keep their state transposed, so switching between them restarts it.
+    void setNumStages(int newNumStages) noexcept
+    {
+        const auto wasPipelined = usesPipeline();
+        numStages = juce::jlimit(1, maxStages, newNumStages);
+
+        if (usesPipeline() != wasPipelined)
+            reset();
+    }
+
+    bool usesPipeline() const noexcept
+    {
+        return lanes == 4 && numStages >= 3 && numStages <= lanes && numChannelsPrepared <= lanes / 2
+            && !independentLanes;
+    }
+
+    // Lets each lane run its own sections (see the per-lane setters below). The pipeline
+    // spreads stages rather than channels across the lanes, so it is not used meanwhile.
+    void setIndependentLanes(bool shouldBeIndependent) noexcept
+    {
+        const auto wasPipelined = usesPipeline();
+        independentLanes = shouldBeIndependent;
+
+        if (usesPipeline() != wasPipelined)
+            reset();
+    }
+
+    // True once every active state value has decayed below the threshold, i.e. the tail
+    // has rung out and further silent input would only produce (denormal) noise.
+    bool isSettled(SampleType threshold) const noexcept
+    {
+        auto peak = Vec::expand(SampleType(0));
+
+        if (usesPipeline())
+        {
+            for (const auto& s : pipelineState)
+                peak = Vec::max(peak, Vec::max(Vec::abs(s.s1), Vec::abs(s.s2)));
+        }
+        else
+        {
+            for (int group = 0; group < numGroups; ++group)
+                for (int stage = 0; stage < numStages; ++stage)
+                {
+                    const auto& s = state[(size_t)(group * maxStages + stage)];
+                    peak = Vec::max(peak, Vec::max(Vec::abs(s.s1), Vec::abs(s.s2)));
+                }
+        }
+
+        for (size_t lane = 0; lane < static_cast<size_t>(lanes); ++lane)
+            if (peak.get(lane) >= threshold)
+                return false;
+
+        return true;
+    }
+
+    int getNumStages() const noexcept { return numStages; }
+
+    // Must match the designs loaded into every stage; SectionForm::general fits any design.
+    // Linear ramps between two designs of one form stay in that form.
+    void setSectionForm(SectionForm newForm) noexcept { form = newForm; }
+
+    // Odd orders end on a first-order section, loaded into the last stage as a second-order
+    // design with one pole cancelled. That stage always runs the general section, so the
+    // form only has to match the others.
+    void setOddOrder(bool shouldEndOnFirstOrder) noexcept { oddOrder = shouldEndOnFirstOrder; }
+
+    // Loads the same section into every lane, taking effect immediately.
+    void setCoefficients(int stage, const BiquadCoefficients& design) noexcept
+    {
+        coefficients[(size_t)stage] = targets[(size_t)stage] = StageCoefficients::broadcast(design);
+        pipelineCoefficients.setLane(stage, design);
+        pipelineTargets.setLane(stage, design);
+    }
+
+    // Sets the section the cascade should arrive at by the end of the next process() call.
+    // Every coefficient moves there in equal per-sample steps over that call.
+    void setTargetCoefficients(int stage, const BiquadCoefficients& design) noexcept
+    {
+        targets[(size_t)stage] = StageCoefficients::broadcast(design);
+        pipelineTargets.setLane(stage, design);
+        ramping = true;
+    }
+
+    // Per-lane versions, for lanes carrying different signals: the lane is the channel's
+    // index within its group, so the section applies to that lane of every group.
+    void setCoefficients(int stage, int lane, const BiquadCoefficients& design) noexcept
+    {
+        coefficients[(size_t)stage].setLane(lane, design);
+        targets[(size_t)stage].setLane(lane, design);
+    }
+
+    void setTargetCoefficients(int stage, int lane, const BiquadCoefficients& design) noexcept
+    {
+        targets[(size_t)stage].setLane(lane, design);
+        ramping = true;
+    }
+
+    void process(const juce::dsp::AudioBlock<SampleType>& block) noexcept
+    {
+        const auto numChannels = static_cast<int>(block.getNumChannels());
+        const auto numSamples = static_cast<int>(block.getNumSamples());
+
+        jassert(numChannels <= numGroups * lanes);
+
+        if (numSamples == 0)
+            return;
+
+        if (usesPipeline())
+        {
+            // The pipeline takes numStages - 1 extra steps to drain, so the ramp spans those too.
+            const auto delta = StageCoefficients::stepTowards(pipelineTargets, pipelineCoefficients,
+                                                              numSamples + numStages - 1);
+
+            // Every stage shares one lane-parallel tick here, so a first-order stage needs the general one.
+            const auto kernel = getPipelineKernel(oddOrder ? SectionForm::general : form, ramping);
+
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                auto c = pipelineCoefficients;
+                auto* data = block.getChannelPointer(static_cast<size_t>(channel));
+
+                (this->*kernel)(c, delta, data, numSamples, pipelineState[(size_t)channel]);
+            }
+        }
+        else
+        {
+            StageArray deltas;
+            const auto kernel = getGroupKernel(numStages, form, oddOrder, ramping);
+
+            if (ramping)
+                for (int stage = 0; stage < numStages; ++stage)
+                    deltas[(size_t)stage] = StageCoefficients::stepTowards(targets[(size_t)stage],
+                                                                           coefficients[(size_t)stage], numSamples);
+
+            for (int group = 0; group < numGroups; ++group)
+            {
+                const auto firstChannel = group * lanes;
+                const auto groupChannels = juce::jmin(lanes, numChannels - firstChannel);
+
+                if (groupChannels <= 0)
+                    break;
+
+                auto c = coefficients;
+
+                for (int start = 0; start < numSamples; start += scratch.getMaximumLength())
+                {
+                    const auto length = juce::jmin(scratch.getMaximumLength(), numSamples - start);
+
+                    scratch.interleave(block, firstChannel, groupChannels, start, length);
+                    (this->*kernel)(c, deltas, state.data() + group * maxStages, length);
+                    scratch.deinterleave(block, firstChannel, groupChannels, start, length);
+                }
+            }
+        }
+
+        // Land exactly on the targets rather than on the accumulated steps.
+        if (ramping)
+        {
+            coefficients = targets;
+            pipelineCoefficients = pipelineTargets;
+            ramping = false;
+        }
+    }
+
+private:
+    struct StageCoefficients
+    {
+        Vec b0{ Vec::expand(SampleType(1)) };
+        Vec b1{ Vec::expand(SampleType(0)) };
+        Vec b2{ Vec::expand(SampleType(0)) };
+        Vec a1{ Vec::expand(SampleType(0)) };
+        Vec a2{ Vec::expand(SampleType(0)) };
+
+        static StageCoefficients broadcast(const BiquadCoefficients& design) noexcept
+        {
+            return { Vec::expand(static_cast<SampleType>(design.b0)),
+                     Vec::expand(static_cast<SampleType>(design.b1)),
+                     Vec::expand(static_cast<SampleType>(design.b2)),
+                     Vec::expand(static_cast<SampleType>(design.a1)),
+                     Vec::expand(static_cast<SampleType>(design.a2)) };
+        }
+
+        void setLane(int lane, const BiquadCoefficients& design) noexcept
+        {
+            if (lane >= lanes)
+                return;
+
+            const auto index = static_cast<size_t>(lane);
+            b0.set(index, static_cast<SampleType>(design.b0));
+            b1.set(index, static_cast<SampleType>(design.b1));
+            b2.set(index, static_cast<SampleType>(design.b2));
+            a1.set(index, static_cast<SampleType>(design.a1));
+            a2.set(index, static_cast<SampleType>(design.a2));
+        }
+
+        static StageCoefficients stepTowards(const StageCoefficients& target, const StageCoefficients& current,
+                                             int numSteps) noexcept
+        {
+            const auto scale = Vec::expand(SampleType(1) / static_cast<SampleType>(juce::jmax(1, numSteps)));
+            return { (target.b0 - current.b0) * scale,
+                     (target.b1 - current.b1) * scale,
+                     (target.b2 - current.b2) * scale,
+                     (target.a1 - current.a1) * scale,
+                     (target.a2 - current.a2) * scale };
+        }
+
+        void advance(const StageCoefficients& delta) noexcept
+        {
+            b0 += delta.b0;
+            b1 += delta.b1;
+            b2 += delta.b2;
+            a1 += delta.a1;
+            a2 += delta.a2;
+        }
+    };
+
+    struct StageState
+    {
+        Vec s1;
+        Vec s2;
+    };
+
+    using StageArray = std::array<StageCoefficients, maxStages>;
+
+    // One sample through one section. The specialised forms rebuild b1 and b2 from b0 (or
+    // b1 from a1 for the notch), which the designs and their linear ramps both satisfy.
+    template <SectionForm Form>
+    static Vec tick(const StageCoefficients& c, Vec x, Vec& s1, Vec& s2) noexcept
+    {
+        if constexpr (Form == SectionForm::highPass || Form == SectionForm::lowPass)
+        {
+            const auto t = c.b0 * x;
+            const auto y = t + s1;
+
+            if constexpr (Form == SectionForm::highPass)
+                s1 = s2 - (t + t) - c.a1 * y;
+            else
+                s1 = s2 + (t + t) - c.a1 * y;
+
+            s2 = t - c.a2 * y;
+            return y;
+        }
+        else if constexpr (Form == SectionForm::bandPass)
+        {
+            const auto y = c.b0 * x + s1;
+            s1 = s2 - c.a1 * y;
+            s2 = c.b2 * x - c.a2 * y;
+            return y;
+        }
+        else if constexpr (Form == SectionForm::notch)
+        {
+            const auto t = c.b0 * x;
+            const auto y = t + s1;
+            s1 = c.a1 * (x - y) + s2;
+            s2 = t - c.a2 * y;
+            return y;
+        }
+        else
+        {
+            const auto y = c.b0 * x + s1;
+            s1 = c.b1 * x - c.a1 * y + s2;
+            s2 = c.b2 * x - c.a2 * y;
+            return y;
+        }
+    }
+
+    // All stages of one lane group, unrolled, with each stage's state held in registers
+    // for the whole pass.
+    template <SectionForm Form, bool OddOrder, bool Ramp, size_t... Stage>
+    void runStages(StageArray& c, const StageArray& delta, StageState* st, int length,
+                      std::index_sequence<Stage...>) noexcept
+    {
+        auto* data = scratch.getData();
+        Vec s1[] = { st[Stage].s1... };
+        Vec s2[] = { st[Stage].s2... };
+
+        for (int i = 0; i < length; ++i)
+        {
+            if constexpr (Ramp)
+                (c[Stage].advance(delta[Stage]), ...);
+
+            auto x = Vec::fromRawArray(data + i * lanes);
+            ((x = tick<(OddOrder && Stage + 1 == sizeof...(Stage)) ? SectionForm::general : Form>(
+                      c[Stage], x, s1[Stage], s2[Stage])), ...);
+            x.copyToRawArray(data + i * lanes);
+        }
+
+        ((st[Stage].s1 = s1[Stage]), ...);
+        ((st[Stage].s2 = s2[Stage]), ...);
+    }
+
+    template <int NumStages, SectionForm Form, bool OddOrder, bool Ramp>
+    void processGroup(StageArray& c, const StageArray& delta, StageState* st, int length) noexcept
+    {
+        runStages<Form, OddOrder, Ramp>(c, delta, st, length, std::make_index_sequence<NumStages>());
+    }
+
+    using GroupKernel = void (BiquadCascade::*)(StageArray&, const StageArray&, StageState*, int) noexcept;
+    using PipelineKernel = void (BiquadCascade::*)(StageCoefficients&, const StageCoefficients&,
+                                                   SampleType*, int, StageState&) noexcept;
+
+    // Index = ((stages - 1) * numSectionForms + form) * 2 + oddOrder.
+    template <bool Ramp, size_t... Index>
+    static constexpr std::array<GroupKernel, sizeof...(Index)> makeGroupKernels(std::index_sequence<Index...>) noexcept
+    {
+        return { &BiquadCascade::processGroup<static_cast<int>(Index) / (2 * numSectionForms) + 1,
+                                              static_cast<SectionForm>(static_cast<int>(Index) / 2 % numSectionForms),
+                                              (Index % 2) != 0,
+                                              Ramp>... };
+    }
+
+    template <bool Ramp, size_t... Index>
+    static constexpr std::array<PipelineKernel, sizeof...(Index)> makePipelineKernels(std::index_sequence<Index...>) noexcept
+    {
+        return { &BiquadCascade::processPipelined<static_cast<SectionForm>(Index), Ramp>... };
+    }
+
+    static GroupKernel getGroupKernel(int stages, SectionForm sectionForm, bool odd, bool ramp) noexcept
+    {
+        static constexpr auto steady = makeGroupKernels<false>(std::make_index_sequence<maxStages * numSectionForms * 2>());
+        static constexpr auto ramped = makeGroupKernels<true>(std::make_index_sequence<maxStages * numSectionForms * 2>());
+
+        const auto index = static_cast<size_t>(((stages - 1) * numSectionForms + static_cast<int>(sectionForm)) * 2
+                                               + (odd ? 1 : 0));
+        return ramp ? ramped[index] : steady[index];
+    }
+
+    static PipelineKernel getPipelineKernel(SectionForm sectionForm, bool ramp) noexcept
+    {
+        static constexpr auto steady = makePipelineKernels<false>(std::make_index_sequence<numSectionForms>());
+        static constexpr auto ramped = makePipelineKernels<true>(std::make_index_sequence<numSectionForms>());
+
+        const auto index = static_cast<size_t>(sectionForm);
+        return ramp ? ramped[index] : steady[index];
+    }
+
+    // Moves every lane up by one and feeds the new sample into lane 0.
+    static Vec shiftIn(Vec v, SampleType sample) noexcept
+    {
+#if PFILTER_PIPELINE_SSE
+        if constexpr (std::is_same_v<typename Vec::vSIMDType, __m128>)
+            return Vec::fromNative(_mm_move_ss(_mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(v.value), 4)),
+                                               _mm_set_ss(sample)));
+#elif PFILTER_PIPELINE_NEON
+        if constexpr (std::is_same_v<typename Vec::vSIMDType, float32x4_t>)
+            return Vec::fromNative(vextq_f32(vdupq_n_f32(sample), v.value, 3));
+#endif
+
+        Vec shifted;
+        shifted.set(0, sample);
+
+        for (size_t lane = 1; lane < static_cast<size_t>(lanes); ++lane)
+            shifted.set(lane, v.get(lane - 1));
+
+        return shifted;
+    }
+
+    // Step t runs stage k on sample t - k. Steps where every stage has a valid sample
+    // need no masking; the fill and drain steps at either end of the block blend the
+    // state so that stages without a sample yet (or any more) stay untouched.
+    template <SectionForm Form, bool Ramp>
+    void processPipelined(StageCoefficients& c, const StageCoefficients& delta,
+                          SampleType* data, int numSamples, StageState& st) noexcept
+    {
+        const auto last = numStages - 1;
+        const auto numSteps = numSamples + last;
+
+        auto s1 = st.s1;
+        auto s2 = st.s2;
+        auto y = Vec::expand(SampleType(0));
+
+        auto maskedStep = [&](int t)
+        {
+            if constexpr (Ramp)
+                c.advance(delta);
+
+            const auto x = shiftIn(y, t < numSamples ? data[t] : SampleType(0));
+            const auto active = Vec::lessThanOrEqual(laneIndex, Vec::expand(static_cast<SampleType>(t)))
+                              & Vec::greaterThan(laneIndex, Vec::expand(static_cast<SampleType>(t - numSamples)));
+
+            auto next1 = s1;
+            auto next2 = s2;
+            const auto out = tick<Form>(c, x, next1, next2);
+
+            s1 = (next1 & active) + (s1 & ~active);
+            s2 = (next2 & active) + (s2 & ~active);
+            y = out;
+
+            if (t >= last)
+                data[t - last] = out.get(static_cast<size_t>(last));
+        };
+
+        const auto steadyEnd = juce::jmax(last, numSamples);
+
+        for (int t = 0; t < juce::jmin(last, numSteps); ++t)
+            maskedStep(t);
+
+        for (int t = last; t < numSamples; ++t)
+        {
+            if constexpr (Ramp)
+                c.advance(delta);
+
+            const auto x = shiftIn(y, data[t]);
+            const auto out = tick<Form>(c, x, s1, s2);
+            y = out;
+            data[t - last] = out.get(static_cast<size_t>(last));
+        }
+
+        for (int t = steadyEnd; t < numSteps; ++t)
+            maskedStep(t);
+
+        st.s1 = s1;
+        st.s2 = s2;
+    }
+
+    std::array<StageCoefficients, maxStages> coefficients;
+    std::array<StageCoefficients, maxStages> targets;
+    std::vector<StageState> state;
+
+    StageCoefficients pipelineCoefficients;
+    StageCoefficients pipelineTargets;
+    std::vector<StageState> pipelineState;
+    Vec laneIndex{ Vec::expand(SampleType(0)) };
+    InterleavedLanes<SampleType> scratch;
+
+    int numChannelsPrepared{ 1 };
+    int numGroups{ 1 };
+    int numStages{ 1 };
+    SectionForm form{ SectionForm::general };
+    bool oddOrder{ false };
+    bool independentLanes{ false };
+    bool ramping{ false };
+};
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Peak detector with separate attack and release, run at control rate: each call reduces
+// a whole control interval to its peak in one vectorised pass over every channel, then
+// takes a single detector step covering the interval. That step is exact for a one-pole
+// detector fed the peak throughout the interval, so the attack and release times hold
+// whatever the update interval, and the per-sample cost is the min/max scan alone.
+class EnvelopeFollower
+{
+public:
+    void prepare(double newSampleRate) noexcept
+    {
+        sampleRate = newSampleRate;
+        reset();
+    }
+
+    void reset() noexcept { envelope = 0.0f; }
+
+    void setAttackAndRelease(float attackMs, float releaseMs) noexcept
+    {
+        attackRate = getRate(attackMs);
+        releaseRate = getRate(releaseMs);
+    }
+
+    // Advances over the block and returns the envelope at its end, as linear gain.
+    template <typename SampleType>
+    float process(const juce::dsp::AudioBlock<SampleType>& block) noexcept
+    {
+        const auto numSamples = static_cast<int>(block.getNumSamples());
+
+        if (numSamples == 0)
+            return envelope;
+
+        float peak = 0.0f;
+
+        for (size_t ch = 0; ch < block.getNumChannels(); ++ch)
+        {
+            const auto range = juce::FloatVectorOperations::findMinAndMax(block.getChannelPointer(ch), numSamples);
+            peak = juce::jmax(peak, static_cast<float>(juce::jmax(-range.getStart(), range.getEnd())));
+        }
+
+        const auto rate = peak > envelope ? attackRate : releaseRate;
+        envelope = peak + (envelope - peak) * std::exp(rate * static_cast<float>(numSamples));
+        return envelope;
+    }
+
+    float getEnvelope() const noexcept { return envelope; }
+
+private:
+    // Per-sample exponent of the one-pole coefficient: exp(rate) after one sample.
+    float getRate(float timeMs) const noexcept
+    {
+        return -1.0f / static_cast<float>(juce::jmax(1.0e-6, 0.001 * timeMs * sampleRate));
+    }
+
+    double sampleRate{ 44100.0 };
+    float attackRate{ -1.0f };
+    float releaseRate{ -1.0f };
+    float envelope{ 0.0f };
+};
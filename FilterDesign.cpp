@@ -0,0 +1,391 @@
+#include "FilterDesign.h"
+
+BiquadCoefficients BiquadCoefficients::makeHighPass(double sampleRate, double frequency, double q) noexcept
+{
+    return makeHighPassFromGain(getPrewarpedGain(sampleRate, frequency), q);
+}
+
+BiquadCoefficients BiquadCoefficients::makeLowPass(double sampleRate, double frequency, double q) noexcept
+{
+    return makeLowPassFromGain(getPrewarpedGain(sampleRate, frequency), q);
+}
+
+BiquadCoefficients BiquadCoefficients::makeBandPass(double sampleRate, double frequency, double q) noexcept
+{
+    return makeBandPassFromGain(getPrewarpedGain(sampleRate, frequency), q);
+}
+
+BiquadCoefficients BiquadCoefficients::makeNotch(double sampleRate, double frequency, double q) noexcept
+{
+    return makeNotchFromGain(getPrewarpedGain(sampleRate, frequency), q);
+}
+
+BiquadCoefficients BiquadCoefficients::makeHighPassFromGain(double gain, double q) noexcept
+{
+    const auto n = gain;
+    const auto nSquared = n * n;
+    const auto invQ = 1.0 / q;
+    const auto c1 = 1.0 / (1.0 + invQ * n + nSquared);
+
+    return { c1, c1 * -2.0, c1,
+             c1 * 2.0 * (nSquared - 1.0),
+             c1 * (1.0 - invQ * n + nSquared) };
+}
+
+BiquadCoefficients BiquadCoefficients::makeLowPassFromGain(double gain, double q) noexcept
+{
+    const auto n = 1.0 / gain;
+    const auto nSquared = n * n;
+    const auto invQ = 1.0 / q;
+    const auto c1 = 1.0 / (1.0 + invQ * n + nSquared);
+
+    return { c1, c1 * 2.0, c1,
+             c1 * 2.0 * (1.0 - nSquared),
+             c1 * (1.0 - invQ * n + nSquared) };
+}
+
+BiquadCoefficients BiquadCoefficients::makeBandPassFromGain(double gain, double q) noexcept
+{
+    const auto n = 1.0 / gain;
+    const auto nSquared = n * n;
+    const auto invQ = 1.0 / q;
+    const auto c1 = 1.0 / (1.0 + invQ * n + nSquared);
+
+    return { c1 * n * invQ, 0.0, -c1 * n * invQ,
+             c1 * 2.0 * (1.0 - nSquared),
+             c1 * (1.0 - invQ * n + nSquared) };
+}
+
+BiquadCoefficients BiquadCoefficients::makeNotchFromGain(double gain, double q) noexcept
+{
+    const auto n = 1.0 / gain;
+    const auto nSquared = n * n;
+    const auto invQ = 1.0 / q;
+    const auto c1 = 1.0 / (1.0 + n * invQ + nSquared);
+    const auto b0 = c1 * (1.0 + nSquared);
+    const auto b1 = 2.0 * c1 * (1.0 - nSquared);
+
+    return { b0, b1, b0, b1,
+             c1 * (1.0 - n * invQ + nSquared) };
+}
+
+// Impulse-invariant poles of the prototype at the cutoff, plus the terms of the squared
+// magnitude |H(w)|^2 = (B0 phi0 + B1 phi1 + B2 phi2) / (A0 phi0 + A1 phi1 + A2 phi2) with
+// phi1 = sin^2(w/2), phi0 = 1 - phi1 and phi2 = 4 phi0 phi1, all evaluated at the cutoff.
+// Each matched design then solves a few of these for its numerator.
+struct MatchedPoles
+{
+    double a1, a2;
+    double phi0, phi1, phi2;
+    double A0, A1, A2;
+
+    // Squared denominator magnitude at the cutoff.
+    double denominator;
+};
+
+static MatchedPoles makeMatchedPoles(double sampleRate, double frequency, double q) noexcept
+{
+    const auto w0 = juce::MathConstants<double>::twoPi * frequency / sampleRate;
+    const auto zeta = 0.5 / q;
+    const auto decay = std::exp(-zeta * w0);
+
+    MatchedPoles p;
+
+    // Overdamped sections (Q below 0.5) have two real poles.
+    p.a1 = zeta <= 1.0 ? -2.0 * decay * std::cos(std::sqrt(1.0 - zeta * zeta) * w0)
+                       : -2.0 * decay * std::cosh(std::sqrt(zeta * zeta - 1.0) * w0);
+    p.a2 = decay * decay;
+
+    const auto halfSine = std::sin(0.5 * w0);
+    p.phi1 = halfSine * halfSine;
+    p.phi0 = 1.0 - p.phi1;
+    p.phi2 = 4.0 * p.phi0 * p.phi1;
+
+    const auto sum = 1.0 + p.a1 + p.a2;
+    const auto difference = 1.0 - p.a1 + p.a2;
+    p.A0 = sum * sum;
+    p.A1 = difference * difference;
+    p.A2 = -4.0 * p.a2;
+
+    p.denominator = p.A0 * p.phi0 + p.A1 * p.phi1 + p.A2 * p.phi2;
+    return p;
+}
+
+BiquadCoefficients BiquadCoefficients::makeMatchedHighPass(double sampleRate, double frequency, double q) noexcept
+{
+    // Double zero at DC; the gain is set so |H| equals Q at the cutoff, as in the prototype.
+    const auto p = makeMatchedPoles(sampleRate, frequency, q);
+    const auto b0 = q * std::sqrt(p.denominator) / (4.0 * p.phi1);
+
+    return { b0, -2.0 * b0, b0, p.a1, p.a2 };
+}
+
+BiquadCoefficients BiquadCoefficients::makeMatchedLowPass(double sampleRate, double frequency, double q) noexcept
+{
+    // Unity gain at DC and |H| = Q at the cutoff; the remaining freedom goes to b1.
+    const auto p = makeMatchedPoles(sampleRate, frequency, q);
+    const auto B0 = p.A0;
+    const auto B1 = juce::jmax(0.0, (p.denominator * q * q - B0 * p.phi0) / p.phi1);
+    const auto b0 = 0.5 * (std::sqrt(B0) + std::sqrt(B1));
+
+    return { b0, std::sqrt(B0) - b0, 0.0, p.a1, p.a2 };
+}
+
+BiquadCoefficients BiquadCoefficients::makeMatchedBandPass(double sampleRate, double frequency, double q) noexcept
+{
+    // Zero at DC, 0 dB at the cutoff and the prototype's slope through it.
+    const auto p = makeMatchedPoles(sampleRate, frequency, q);
+    const auto R1 = p.denominator;
+    const auto R2 = -p.A0 + p.A1 + 4.0 * (p.phi0 - p.phi1) * p.A2;
+    const auto B2 = (R1 - R2 * p.phi1) / (4.0 * p.phi1 * p.phi1);
+    const auto B1 = juce::jmax(0.0, R2 + 4.0 * (p.phi1 - p.phi0) * B2);
+    const auto b1 = -0.5 * std::sqrt(B1);
+    const auto b0 = 0.5 * (std::sqrt(juce::jmax(0.0, B2 + b1 * b1)) - b1);
+
+    return { b0, b1, -b0 - b1, p.a1, p.a2 };
+}
+
+BiquadCoefficients BiquadCoefficients::makeMatchedNotch(double sampleRate, double frequency, double q) noexcept
+{
+    // Zeros exactly on the unit circle at the cutoff, scaled for unity gain at DC.
+    const auto p = makeMatchedPoles(sampleRate, frequency, q);
+    const auto b0 = (1.0 + p.a1 + p.a2) / (4.0 * p.phi1);
+
+    return { b0, -2.0 * b0 * (1.0 - 2.0 * p.phi1), b0, p.a1, p.a2 };
+}
+
+BiquadCoefficients BiquadCoefficients::makeFirstOrderHighPass(double sampleRate, double frequency) noexcept
+{
+    return makeFirstOrderHighPassFromGain(getPrewarpedGain(sampleRate, frequency));
+}
+
+BiquadCoefficients BiquadCoefficients::makeFirstOrderLowPass(double sampleRate, double frequency) noexcept
+{
+    return makeFirstOrderLowPassFromGain(getPrewarpedGain(sampleRate, frequency));
+}
+
+BiquadCoefficients BiquadCoefficients::makeFirstOrderHighPassFromGain(double gain) noexcept
+{
+    const auto c1 = 1.0 / (1.0 + gain);
+
+    return { c1, -c1, 0.0, c1 * (gain - 1.0), 0.0 };
+}
+
+BiquadCoefficients BiquadCoefficients::makeFirstOrderLowPassFromGain(double gain) noexcept
+{
+    const auto c1 = 1.0 / (1.0 + gain);
+
+    return { c1 * gain, c1 * gain, 0.0, c1 * (gain - 1.0), 0.0 };
+}
+
+BiquadCoefficients BiquadCoefficients::makeMatchedFirstOrderHighPass(double sampleRate, double frequency) noexcept
+{
+    // Impulse-invariant pole, zero at DC, and the prototype's gain at Nyquist.
+    const auto pole = std::exp(-juce::MathConstants<double>::twoPi * frequency / sampleRate);
+    const auto nyquistRatio = 0.5 * sampleRate / frequency;
+    const auto nyquistGain = nyquistRatio / std::sqrt(1.0 + nyquistRatio * nyquistRatio);
+    const auto b0 = 0.5 * nyquistGain * (1.0 + pole);
+
+    return { b0, -b0, 0.0, -pole, 0.0 };
+}
+
+BiquadCoefficients BiquadCoefficients::makeMatchedFirstOrderLowPass(double sampleRate, double frequency) noexcept
+{
+    // Impulse-invariant pole, unity gain at DC, and the prototype's gain at Nyquist.
+    const auto pole = std::exp(-juce::MathConstants<double>::twoPi * frequency / sampleRate);
+    const auto nyquistRatio = 0.5 * sampleRate / frequency;
+    const auto nyquistGain = 1.0 / std::sqrt(1.0 + nyquistRatio * nyquistRatio);
+    const auto sum = 1.0 - pole;
+    const auto difference = nyquistGain * (1.0 + pole);
+
+    return { 0.5 * (sum + difference), 0.5 * (sum - difference), 0.0, -pole, 0.0 };
+}
+
+double BiquadCoefficients::getMagnitudeForFrequency(double frequency, double sampleRate) const noexcept
+{
+    const auto w = juce::MathConstants<double>::twoPi * frequency / sampleRate;
+    const auto z1 = std::polar(1.0, -w);
+    const auto z2 = z1 * z1;
+
+    const auto numerator = b0 + b1 * z1 + b2 * z2;
+    const auto denominator = 1.0 + a1 * z1 + a2 * z2;
+
+    return std::abs(numerator / denominator);
+}
+
+double BiquadCoefficients::getPoleRadius() const noexcept
+{
+    // Poles are the roots of z^2 + a1 z + a2.
+    const auto discriminant = a1 * a1 - 4.0 * a2;
+
+    if (discriminant < 0.0)
+        return std::sqrt(a2);
+
+    const auto root = std::sqrt(discriminant);
+    return juce::jmax(std::abs(-a1 + root), std::abs(-a1 - root)) * 0.5;
+}
+
+static StateVariableCoefficients makeStateVariable(double gain, double q, double m0, double m1, double m2) noexcept
+{
+    StateVariableCoefficients c;
+    c.g = gain;
+    c.k = 1.0 / q;
+    c.m0 = m0;
+    c.m1 = m1 * c.k;
+    c.m2 = m2;
+    return c;
+}
+
+StateVariableCoefficients StateVariableCoefficients::makeHighPass(double sampleRate, double frequency, double q) noexcept
+{
+    return makeHighPassFromGain(getPrewarpedGain(sampleRate, frequency), q);
+}
+
+StateVariableCoefficients StateVariableCoefficients::makeLowPass(double sampleRate, double frequency, double q) noexcept
+{
+    return makeLowPassFromGain(getPrewarpedGain(sampleRate, frequency), q);
+}
+
+StateVariableCoefficients StateVariableCoefficients::makeBandPass(double sampleRate, double frequency, double q) noexcept
+{
+    return makeBandPassFromGain(getPrewarpedGain(sampleRate, frequency), q);
+}
+
+StateVariableCoefficients StateVariableCoefficients::makeNotch(double sampleRate, double frequency, double q) noexcept
+{
+    return makeNotchFromGain(getPrewarpedGain(sampleRate, frequency), q);
+}
+
+StateVariableCoefficients StateVariableCoefficients::makeHighPassFromGain(double gain, double q) noexcept
+{
+    return makeStateVariable(gain, q, 1.0, -1.0, -1.0);
+}
+
+StateVariableCoefficients StateVariableCoefficients::makeLowPassFromGain(double gain, double q) noexcept
+{
+    return makeStateVariable(gain, q, 0.0, 0.0, 1.0);
+}
+
+StateVariableCoefficients StateVariableCoefficients::makeBandPassFromGain(double gain, double q) noexcept
+{
+    // Scaled by k for a constant 0 dB peak, matching BiquadCoefficients::makeBandPass.
+    return makeStateVariable(gain, q, 0.0, 1.0, 0.0);
+}
+
+StateVariableCoefficients StateVariableCoefficients::makeNotchFromGain(double gain, double q) noexcept
+{
+    return makeStateVariable(gain, q, 1.0, -1.0, 0.0);
+}
+
+StateVariableCoefficients StateVariableCoefficients::makeFirstOrderHighPass(double sampleRate, double frequency) noexcept
+{
+    return makeFirstOrderHighPassFromGain(getPrewarpedGain(sampleRate, frequency));
+}
+
+StateVariableCoefficients StateVariableCoefficients::makeFirstOrderLowPass(double sampleRate, double frequency) noexcept
+{
+    return makeFirstOrderLowPassFromGain(getPrewarpedGain(sampleRate, frequency));
+}
+
+StateVariableCoefficients StateVariableCoefficients::makeFirstOrderHighPassFromGain(double gain) noexcept
+{
+    // s / (s + 1) = (s^2 + s) / (s + 1)^2 = 1 - band - low at k = 2.
+    return makeStateVariable(gain, 0.5, 1.0, -0.5, -1.0);
+}
+
+StateVariableCoefficients StateVariableCoefficients::makeFirstOrderLowPassFromGain(double gain) noexcept
+{
+    // 1 / (s + 1) = (s + 1) / (s + 1)^2 = band + low at k = 2.
+    return makeStateVariable(gain, 0.5, 0.0, 0.5, 1.0);
+}
+
+BiquadCoefficients StateVariableCoefficients::toBiquad() const noexcept
+{
+    // Bilinear transform of m0 + m1 s / D(s) + m2 / D(s), with D(s) = s^2 + k s + 1.
+    const auto gSquared = g * g;
+    const auto d0 = 1.0 + k * g + gSquared;
+    const auto d1 = 2.0 * (gSquared - 1.0);
+    const auto d2 = 1.0 - k * g + gSquared;
+    const auto invD0 = 1.0 / d0;
+
+    return { (m0 * d0 + m1 * g + m2 * gSquared) * invD0,
+             (m0 * d1 + 2.0 * m2 * gSquared) * invD0,
+             (m0 * d2 - m1 * g + m2 * gSquared) * invD0,
+             d1 * invD0,
+             d2 * invD0 };
+}
+
+StateVariableCoefficients StateVariableCoefficients::fromBiquad(const BiquadCoefficients& section) noexcept
+{
+    // Solve toBiquad()'s denominator for g and k, then its numerator for the mix.
+    const auto sum = 1.0 + section.a1 + section.a2;
+    const auto difference = 1.0 - section.a1 + section.a2;
+    const auto d0 = 4.0 / difference;
+
+    StateVariableCoefficients c;
+    c.g = std::sqrt(sum / difference);
+    c.k = (1.0 - section.a2) * d0 / (2.0 * c.g);
+
+    const auto gSquared = c.g * c.g;
+    const auto n0 = section.b0 * d0;
+    const auto n1 = section.b1 * d0;
+    const auto n2 = section.b2 * d0;
+
+    c.m0 = 0.25 * (n0 - n1 + n2);
+    c.m1 = (n0 - n2 - 2.0 * c.m0 * c.k * c.g) / (2.0 * c.g);
+    c.m2 = (n1 - 2.0 * c.m0 * (gSquared - 1.0)) / (2.0 * gSquared);
+    return c;
+}
+
+void CoefficientSnapshot::publish(const BiquadCoefficients* stages, int stageCount, double sampleRate) noexcept
+{
+    stageCount = juce::jlimit(0, maxStages, stageCount);
+
+    const auto start = version.load(std::memory_order_relaxed);
+    version.store(start + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (int stage = 0; stage < stageCount; ++stage)
+    {
+        auto* dest = values.data() + stage * valuesPerStage;
+        dest[0].store(stages[stage].b0, std::memory_order_relaxed);
+        dest[1].store(stages[stage].b1, std::memory_order_relaxed);
+        dest[2].store(stages[stage].b2, std::memory_order_relaxed);
+        dest[3].store(stages[stage].a1, std::memory_order_relaxed);
+        dest[4].store(stages[stage].a2, std::memory_order_relaxed);
+    }
+
+    numStages.store(stageCount, std::memory_order_relaxed);
+    snapshotSampleRate.store(sampleRate, std::memory_order_relaxed);
+
+    version.store(start + 2, std::memory_order_release);
+}
+
+int CoefficientSnapshot::read(std::array<BiquadCoefficients, maxStages>& stages, double& sampleRate) const noexcept
+{
+    for (;;)
+    {
+        const auto before = version.load(std::memory_order_acquire);
+
+        if ((before & 1u) != 0)
+            continue;
+
+        const auto stageCount = numStages.load(std::memory_order_relaxed);
+        sampleRate = snapshotSampleRate.load(std::memory_order_relaxed);
+
+        for (int stage = 0; stage < stageCount; ++stage)
+        {
+            const auto* src = values.data() + stage * valuesPerStage;
+            stages[(size_t)stage] = { src[0].load(std::memory_order_relaxed),
+                                      src[1].load(std::memory_order_relaxed),
+                                      src[2].load(std::memory_order_relaxed),
+                                      src[3].load(std::memory_order_relaxed),
+                                      src[4].load(std::memory_order_relaxed) };
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        if (version.load(std::memory_order_relaxed) == before)
+            return stageCount;
+    }
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Prewarped integrator gain tan(pi * frequency / sampleRate): the only transcendental
+// in every section design below. PrewarpTable serves it without the tan() during sweeps.
+inline double getPrewarpedGain(double sampleRate, double frequency) noexcept
+{
+    return std::tan(juce::MathConstants<double>::pi * frequency / sampleRate);
+}
+
+// Numerator shape shared by every stage of a cascade. Kernels specialised on it skip the
+// multiplies the design already fixes (b1 = -2 b0 and b2 = b0 for a high-pass, and so on);
+// 'general' runs the full section and suits any design.
+enum class SectionForm
+{
+    general,
+    highPass,
+    lowPass,
+    bandPass,
+    notch
+};
+
+constexpr int numSectionForms = 5;
+
+// Raw second-order section, normalised so that a0 == 1.
+// Designs are always computed in double and converted by whichever kernel runs them.
+struct BiquadCoefficients
+{
+    double b0{ 1.0 };
+    double b1{ 0.0 };
+    double b2{ 0.0 };
+    double a1{ 0.0 };
+    double a2{ 0.0 };
+
+    // Same responses as juce::dsp::IIR::Coefficients::make*, without the heap allocation.
+    static BiquadCoefficients makeHighPass(double sampleRate, double frequency, double q) noexcept;
+    static BiquadCoefficients makeLowPass(double sampleRate, double frequency, double q) noexcept;
+    static BiquadCoefficients makeBandPass(double sampleRate, double frequency, double q) noexcept;
+    static BiquadCoefficients makeNotch(double sampleRate, double frequency, double q) noexcept;
+
+    // The same designs from an already prewarped gain; pure arithmetic, no trig.
+    static BiquadCoefficients makeHighPassFromGain(double gain, double q) noexcept;
+    static BiquadCoefficients makeLowPassFromGain(double gain, double q) noexcept;
+    static BiquadCoefficients makeBandPassFromGain(double gain, double q) noexcept;
+    static BiquadCoefficients makeNotchFromGain(double gain, double q) noexcept;
+
+    // Magnitude-matched designs after Vicanek, "Matched Second Order Digital Filters": the
+    // poles are impulse invariant and the numerator is fitted so the magnitude follows the
+    // analog prototype up to Nyquist instead of cramping towards it. The numerators are
+    // general, so these run with SectionForm::general.
+    static BiquadCoefficients makeMatchedHighPass(double sampleRate, double frequency, double q) noexcept;
+    static BiquadCoefficients makeMatchedLowPass(double sampleRate, double frequency, double q) noexcept;
+    static BiquadCoefficients makeMatchedBandPass(double sampleRate, double frequency, double q) noexcept;
+    static BiquadCoefficients makeMatchedNotch(double sampleRate, double frequency, double q) noexcept;
+
+    // First-order sections for odd orders, as second-order sections with b2 = a2 = 0.
+    static BiquadCoefficients makeFirstOrderHighPass(double sampleRate, double frequency) noexcept;
+    static BiquadCoefficients makeFirstOrderLowPass(double sampleRate, double frequency) noexcept;
+    static BiquadCoefficients makeFirstOrderHighPassFromGain(double gain) noexcept;
+    static BiquadCoefficients makeFirstOrderLowPassFromGain(double gain) noexcept;
+    static BiquadCoefficients makeMatchedFirstOrderHighPass(double sampleRate, double frequency) noexcept;
+    static BiquadCoefficients makeMatchedFirstOrderLowPass(double sampleRate, double frequency) noexcept;
+
+    double getMagnitudeForFrequency(double frequency, double sampleRate) const noexcept;
+
+    // Magnitude of the slower-decaying pole; below 1 for every stable section.
+    double getPoleRadius() const noexcept;
+};
+
+// Topology-preserving (zero-delay feedback) state-variable section.
+// g is the prewarped integrator gain and k the damping (1/Q); the output is the mix
+// m0 * input + m1 * band + m2 * low, which covers every response with one tan() per design.
+struct StateVariableCoefficients
+{
+    double g{ 0.0 };
+    double k{ 1.0 };
+    double m0{ 1.0 };
+    double m1{ 0.0 };
+    double m2{ 0.0 };
+
+    static StateVariableCoefficients makeHighPass(double sampleRate, double frequency, double q) noexcept;
+    static StateVariableCoefficients makeLowPass(double sampleRate, double frequency, double q) noexcept;
+    static StateVariableCoefficients makeBandPass(double sampleRate, double frequency, double q) noexcept;
+    static StateVariableCoefficients makeNotch(double sampleRate, double frequency, double q) noexcept;
+
+    static StateVariableCoefficients makeHighPassFromGain(double gain, double q) noexcept;
+    static StateVariableCoefficients makeLowPassFromGain(double gain, double q) noexcept;
+    static StateVariableCoefficients makeBandPassFromGain(double gain, double q) noexcept;
+    static StateVariableCoefficients makeNotchFromGain(double gain, double q) noexcept;
+
+    // First-order sections for odd orders: a critically damped section (k = 2) whose mix
+    // cancels one of its two coincident poles.
+    static StateVariableCoefficients makeFirstOrderHighPass(double sampleRate, double frequency) noexcept;
+    static StateVariableCoefficients makeFirstOrderLowPass(double sampleRate, double frequency) noexcept;
+    static StateVariableCoefficients makeFirstOrderHighPassFromGain(double gain) noexcept;
+    static StateVariableCoefficients makeFirstOrderLowPassFromGain(double gain) noexcept;
+
+    // The equivalent direct-form section, derived without any trig (used for the GUI curve).
+    BiquadCoefficients toBiquad() const noexcept;
+
+    // Inverse of toBiquad(): realises any stable section as a state-variable mix.
+    static StateVariableCoefficients fromBiquad(const BiquadCoefficients& section) noexcept;
+};
+
+// Single-writer / multi-reader copy of the running cascade for the GUI.
+// The audio thread publishes without locking or allocating; readers retry if they
+// catch a publish in progress.
+class CoefficientSnapshot
+{
+public:
+    // Eight sections reach 96 dB/oct; odd orders use the last one as a first-order section.
+    static constexpr int maxStages = 8;
+
+    void publish(const BiquadCoefficients* stages, int numStages, double sampleRate) noexcept;
+
+    // Returns the number of valid stages copied into the array.
+    int read(std::array<BiquadCoefficients, maxStages>& stages, double& sampleRate) const noexcept;
+
+    // Changes on every publish, so readers that derive something from the cascade can tell
+    // when to redo it.
+    juce::uint32 getVersion() const noexcept { return version.load(std::memory_order_acquire); }
+
+private:
+    static constexpr int valuesPerStage = 5;
+
+    std::atomic<juce::uint32> version{ 0 };
+    std::atomic<int> numStages{ 0 };
+    std::atomic<double> snapshotSampleRate{ 44100.0 };
+    std::array<std::atomic<double>, maxStages * valuesPerStage> values{};
+};
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Aligned scratch that packs one register's worth of channels side by side, so a
+// cascade kernel can load one sample of every channel in a group with a single load.
+template <typename SampleType>
+class InterleavedLanes
+{
+public:
+    using Vec = juce::dsp::SIMDRegister<SampleType>;
+
+    static constexpr int lanes = static_cast<int>(Vec::SIMDNumElements);
+
+    void prepare(int maximumBlockSize)
+    {
+        maximumLength = juce::jmax(1, maximumBlockSize);
+        storage.resize(static_cast<size_t>(maximumLength));
+    }
+
+    int getMaximumLength() const noexcept { return maximumLength; }
+
+    SampleType* getData() noexcept { return reinterpret_cast<SampleType*>(storage.data()); }
+
+    void interleave(const juce::dsp::AudioBlock<SampleType>& block, int firstChannel, int groupChannels,
+                    int start, int length) noexcept
+    {
+        auto* dest = getData();
+
+        for (int lane = 0; lane < lanes; ++lane)
+        {
+            if (lane < groupChannels)
+            {
+                const auto* src = block.getChannelPointer(static_cast<size_t>(firstChannel + lane)) + start;
+
+                for (int i = 0; i < length; ++i)
+                    dest[i * lanes + lane] = src[i];
+            }
+            else
+            {
+                // Spare lanes carry silence so their state never leaves zero.
+                for (int i = 0; i < length; ++i)
+                    dest[i * lanes + lane] = SampleType(0);
+            }
+        }
+    }
+
+    void deinterleave(const juce::dsp::AudioBlock<SampleType>& block, int firstChannel, int groupChannels,
+                      int start, int length) noexcept
+    {
+        const auto* src = getData();
+
+        for (int lane = 0; lane < groupChannels; ++lane)
+        {
+            auto* dest = block.getChannelPointer(static_cast<size_t>(firstChannel + lane)) + start;
+
+            for (int i = 0; i < length; ++i)
+                dest[i] = src[i * lanes + lane];
+        }
+    }
+
+private:
+    std::vector<Vec> storage;
+    int maximumLength{ 0 };
+};
@@ -0,0 +1,158 @@
+#include "LinearPhaseFilter.h"
+
+LinearPhaseFilter::LinearPhaseFilter(const CoefficientSnapshot& source)
+    : juce::Thread("Linear-phase FIR design"), snapshot(source)
+{
+}
+
+LinearPhaseFilter::~LinearPhaseFilter()
+{
+    stopDesigning();
+}
+
+void LinearPhaseFilter::prepare(double newSampleRate, int newNumChannels)
+{
+    stopDesigning();
+
+    sampleRate = newSampleRate;
+    numChannels = newNumChannels;
+    filterLength = juce::jmax(4096, juce::nextPowerOfTwo(juce::roundToInt(0.3 * sampleRate)));
+
+    ready.store(false, std::memory_order_release);
+    designFFT.reset();
+    designBuffer = {};
+    window = {};
+    taps = {};
+
+    for (auto& kernel : kernels)
+        kernel.spectra = {};
+}
+
+void LinearPhaseFilter::allocate()
+{
+    convolver.prepare(filterLength, numChannels);
+
+    for (auto& kernel : kernels)
+        convolver.allocateKernel(kernel);
+
+    // The first kernel goes to the convolver in beginDesigning(); the rest start free.
+    numFreeKernels = 0;
+
+    for (size_t index = 1; index < kernels.size(); ++index)
+        freeKernels[(size_t)numFreeKernels++] = &kernels[index];
+
+    // The magnitude is sampled four times more finely than the FIR is long, so the
+    // response folded back by the inverse transform is negligible once windowed.
+    const auto designLength = 4 * filterLength;
+    designFFT = std::make_unique<juce::dsp::FFT>(juce::roundToInt(std::log2(designLength)));
+    designBuffer.assign(static_cast<size_t>(2 * designLength), 0.0f);
+    taps.assign(static_cast<size_t>(filterLength), 0.0f);
+
+    // One period longer than the FIR, so it is zero at tap 0 and symmetric about the centre
+    // tap: exactly linear phase with a whole-sample delay.
+    window.assign(static_cast<size_t>(filterLength + 1), 0.0f);
+    juce::dsp::WindowingFunction<float>::fillWindowingTables(window.data(), window.size(),
+        juce::dsp::WindowingFunction<float>::kaiser, false, 10.0f);
+}
+
+void LinearPhaseFilter::beginDesigning()
+{
+    if (filterLength == 0)
+        return;
+
+    // The audio thread leaves the convolver alone until it is ready.
+    if (!isReady())
+    {
+        allocate();
+
+        designedVersion = snapshot.getVersion();
+        design(kernels[0]);
+        convolver.setKernel(&kernels[0]);
+
+        ready.store(true, std::memory_order_release);
+    }
+
+    convolver.startWorker();
+    startThread();
+}
+
+void LinearPhaseFilter::stopDesigning()
+{
+    stopThread(1000);
+    convolver.stopWorker();
+}
+
+void LinearPhaseFilter::run()
+{
+    while (!threadShouldExit())
+    {
+        if (auto* finished = convolver.takeReturned())
+            freeKernels[(size_t)numFreeKernels++] = finished;
+
+        const auto version = snapshot.getVersion();
+        bool waitingForKernel = false;
+
+        if (version != designedVersion)
+        {
+            // With no kernel free the convolver is still fading between two; the change is
+            // picked up once one comes back.
+            if (numFreeKernels > 0)
+            {
+                designedVersion = version;
+
+                auto* kernel = freeKernels[(size_t)--numFreeKernels];
+                design(*kernel);
+
+                if (auto* superseded = convolver.offerKernel(kernel))
+                    freeKernels[(size_t)numFreeKernels++] = superseded;
+
+                continue;
+            }
+
+            waitingForKernel = true;
+        }
+
+        wait(waitingForKernel ? retryIntervalMs : -1);
+    }
+}
+
+void LinearPhaseFilter::design(NonUniformConvolver::Kernel& kernel)
+{
+    std::array<BiquadCoefficients, CoefficientSnapshot::maxStages> stages;
+    double cascadeRate = sampleRate;
+    const auto numStages = snapshot.read(stages, cascadeRate);
+
+    // Zero phase: a real spectrum equal to the cascade's magnitude at every bin. The
+    // cascade may run oversampled, so it is evaluated at its own rate.
+    const auto designLength = designFFT->getSize();
+    const auto radiansPerBin = juce::MathConstants<double>::twoPi * sampleRate / (designLength * cascadeRate);
+
+    for (int bin = 0; bin <= designLength / 2; ++bin)
+    {
+        const auto z1 = std::polar(1.0, -radiansPerBin * bin);
+        const auto z2 = z1 * z1;
+        double magnitude = 1.0;
+
+        for (int stage = 0; stage < numStages; ++stage)
+        {
+            const auto& s = stages[(size_t)stage];
+            magnitude *= std::abs((s.b0 + s.b1 * z1 + s.b2 * z2) / (1.0 + s.a1 * z1 + s.a2 * z2));
+        }
+
+        designBuffer[(size_t)(2 * bin)] = static_cast<float>(magnitude);
+        designBuffer[(size_t)(2 * bin + 1)] = 0.0f;
+    }
+
+    designFFT->performRealOnlyInverseTransform(designBuffer.data());
+
+    // The impulse is centred on sample 0; move the centre to the middle tap and window it.
+    const auto centre = filterLength / 2;
+
+    for (int tap = 0; tap < filterLength; ++tap)
+    {
+        const auto source = (tap - centre + designLength) % designLength;
+        taps[(size_t)tap] = designBuffer[(size_t)source] * window[(size_t)tap];
+    }
+
+    convolver.fillKernel(taps.data(), kernel);
+}
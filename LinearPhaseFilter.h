@@ -0,0 +1,99 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "FilterDesign.h"
+#include "NonUniformConvolver.h"
+
+// Zero-phase-shift version of whatever cascade is published to a CoefficientSnapshot: an
+// FIR with the cascade's magnitude, delayed by half its length so it is causal.
+//
+// A background thread wakes when the snapshot changes, samples the cascade's magnitude,
+// turns it into a windowed symmetric FIR and has the convolver split and transform it into
+// a spare kernel, which it then offers to the convolver. The audio thread only runs the
+// convolution (see NonUniformConvolver), which fades to an offered kernel by itself and
+// hands finished ones back. Four kernels circulate, so neither side ever waits for or
+// allocates on behalf of the other.
+//
+// Nothing is allocated and no thread runs until the mode is first used: most instances
+// never leave minimum phase, and the FIR's buffers run to megabytes at high rates.
+//
+// The convolution adds no latency of its own: the latency is half the FIR. The FIR is
+// about 0.3 s long at any rate (16384 taps at 44.1 and 48 kHz), which resolves the steep
+// slopes down to the bottom of the cutoff range.
+class LinearPhaseFilter : private juce::Thread
+{
+public:
+    explicit LinearPhaseFilter(const CoefficientSnapshot& source);
+    ~LinearPhaseFilter() override;
+
+    // Stops the design and convolution threads and frees what the last rate used; the
+    // buffers for the new one wait for beginDesigning(). Call from prepareToPlay.
+    void prepare(double newSampleRate, int newNumChannels);
+
+    // Not for the audio thread. The first call after prepare() allocates and designs the
+    // first kernel from the snapshot on the calling thread, so processing starts filtered;
+    // every call (re)starts both threads, which pick up whatever changed in the meantime.
+    void beginDesigning();
+    void stopDesigning();
+
+    // True once beginDesigning() has set the filter up: until then it must not process.
+    bool isReady() const noexcept { return ready.load(std::memory_order_acquire); }
+
+    // Wakes the design thread; call after publishing to the snapshot.
+    void snapshotChanged() noexcept { notify(); }
+
+    void reset() noexcept
+    {
+        if (isReady())
+            convolver.reset();
+    }
+
+    // Audio thread; see NonUniformConvolver::setNonRealtime().
+    void setNonRealtime(bool shouldBeNonRealtime) noexcept { convolver.setNonRealtime(shouldBeNonRealtime); }
+
+    // Filters the block in place. While bypassed the input only goes through the latency,
+    // so the host's compensation still lines up. The convolution runs in single precision,
+    // as juce::dsp::FFT does; double blocks are converted on the way in and out.
+    template <typename SampleType>
+    void process(const juce::dsp::AudioBlock<SampleType>& block, bool bypassed) noexcept
+    {
+        convolver.process(block, bypassed);
+    }
+
+    int getLatencySamples() const noexcept { return filterLength / 2; }
+
+    // Output left once the input falls silent, past the latency.
+    int getTailSamples() const noexcept { return filterLength / 2; }
+
+private:
+    static constexpr int numKernels = 4;
+
+    // Only while a change waits for a kernel to come back from the convolver.
+    static constexpr int retryIntervalMs = 10;
+
+    void run() override;
+    void allocate();
+    void design(NonUniformConvolver::Kernel& kernel);
+
+    const CoefficientSnapshot& snapshot;
+    std::atomic<bool> ready{ false };
+
+    double sampleRate{ 44100.0 };
+    int numChannels{ 0 };
+    int filterLength{ 0 };
+
+    NonUniformConvolver convolver;
+
+    // Design thread (or the caller of beginDesigning() while it is stopped).
+    std::unique_ptr<juce::dsp::FFT> designFFT;
+    std::vector<float> designBuffer;
+    std::vector<float> window;
+    std::vector<float> taps;
+    juce::uint32 designedVersion{ 0 };
+
+    std::array<NonUniformConvolver::Kernel, numKernels> kernels;
+    std::array<NonUniformConvolver::Kernel*, numKernels> freeKernels{};
+    int numFreeKernels{ 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LinearPhaseFilter)
+};
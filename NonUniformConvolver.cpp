@@ -0,0 +1,561 @@
+#include "NonUniformConvolver.h"
+
+// Block sizes of the levels the worker runs; each starts at twice its block size and ends
+// where the next one starts.
+static constexpr int workerBlockSizes[] = { 256, 1024, 2048 };
+
+static void runDirectForm(const float* taps, const float* input, float* output, int count) noexcept
+{
+    // One tap at a time across the chunk, so every step is a plain vector multiply-add.
+    juce::FloatVectorOperations::multiply(output, input, taps[0], count);
+
+    for (int tap = 1; tap < NonUniformConvolver::directLength; ++tap)
+        juce::FloatVectorOperations::addWithMultiply(output, input - tap, taps[tap], count);
+}
+
+NonUniformConvolver::NonUniformConvolver()
+    : juce::Thread("Convolution worker")
+{
+}
+
+NonUniformConvolver::~NonUniformConvolver()
+{
+    stopWorker();
+}
+
+void NonUniformConvolver::prepare(int filterLength, int numChannels)
+{
+    stopWorker();
+
+    preparedChannels = numChannels;
+    dryDelay = filterLength / 2;
+    numLevels = 0;
+
+    size_t kernelOffset = 0;
+
+    auto addLevel = [&](int blockSize, int firstTap, int lastTap)
+    {
+        if (lastTap <= firstTap)
+            return;
+
+        auto& level = levels[(size_t)numLevels++];
+        level.blockSize = blockSize;
+        level.firstTap = firstTap;
+        level.numPartitions = (lastTap - firstTap) / blockSize;
+        level.numBins = blockSize + 1;
+        level.kernelOffset = kernelOffset;
+
+        const auto transformSize = 2 * blockSize;
+        const auto spectrumSize = static_cast<size_t>(2 * level.numBins);
+        const auto order = juce::roundToInt(std::log2(transformSize));
+
+        level.numSpectra = 2 * level.numPartitions - 1;
+        level.designFFT = std::make_unique<juce::dsp::FFT>(order);
+        level.spectra.assign(static_cast<size_t>(numChannels * level.numSpectra) * spectrumSize, 0.0f);
+        level.recent.resize(static_cast<size_t>(level.numPartitions - 1));
+        std::iota(level.recent.begin(), level.recent.end(), 0);
+        level.outputs.assign(static_cast<size_t>(numChannels * blockSize), 0.0f);
+        level.queued = nullptr;
+
+        for (auto& job : level.jobs)
+        {
+            job.recent.assign(level.recent.size(), 0);
+
+            // Real-only transforms work in place on twice their size.
+            job.fft = std::make_unique<juce::dsp::FFT>(order);
+            job.frames.assign(static_cast<size_t>(numChannels * transformSize), 0.0f);
+            job.spectra.assign(static_cast<size_t>(numChannels) * spectrumSize, 0.0f);
+            job.outputs.assign(static_cast<size_t>(numChannels * blockSize), 0.0f);
+            job.transform.assign(static_cast<size_t>(2 * transformSize), 0.0f);
+            job.accumulator.assign(spectrumSize, 0.0f);
+            job.fade.assign(static_cast<size_t>(blockSize), 0.0f);
+            job.state.store(taskIdle, std::memory_order_relaxed);
+        }
+
+        kernelOffset += static_cast<size_t>(level.numPartitions) * spectrumSize;
+    };
+
+    addLevel(directLength, directLength, juce::jmin(filterLength, 2 * workerBlockSizes[0]));
+
+    for (size_t index = 0; index < std::size(workerBlockSizes); ++index)
+    {
+        const auto blockSize = workerBlockSizes[index];
+        const auto lastTap = index + 1 < std::size(workerBlockSizes) ? 2 * workerBlockSizes[index + 1] : filterLength;
+        addLevel(blockSize, 2 * blockSize, juce::jmin(lastTap, filterLength));
+    }
+
+    maxBlockSize = levels[(size_t)(numLevels - 1)].blockSize;
+
+    // Long enough for the bypass delay and for the largest level's two input blocks.
+    historyLength = juce::nextPowerOfTwo(juce::jmax(dryDelay + directLength, 2 * maxBlockSize));
+    history.assign(static_cast<size_t>(numChannels * 2 * historyLength), 0.0f);
+
+    chunkBuffer.assign(static_cast<size_t>(directLength), 0.0f);
+    fadeChunkBuffer.assign(static_cast<size_t>(directLength), 0.0f);
+    designBuffer.assign(static_cast<size_t>(4 * maxBlockSize), 0.0f);
+
+    current = nullptr;
+    outgoing = nullptr;
+    pending.store(nullptr, std::memory_order_relaxed);
+    returned.store(nullptr, std::memory_order_relaxed);
+    missedBlocks.store(0, std::memory_order_relaxed);
+
+    reset();
+}
+
+void NonUniformConvolver::allocateKernel(Kernel& kernel) const
+{
+    const auto& last = levels[(size_t)(numLevels - 1)];
+    kernel.spectra.assign(last.kernelOffset + static_cast<size_t>(last.numPartitions * 2 * last.numBins), 0.0f);
+}
+
+void NonUniformConvolver::fillKernel(const float* taps, Kernel& kernel)
+{
+    std::copy_n(taps, directLength, kernel.directTaps.begin());
+
+    for (int index = 0; index < numLevels; ++index)
+    {
+        auto& level = levels[(size_t)index];
+        const auto spectrumSize = static_cast<size_t>(2 * level.numBins);
+
+        for (int partition = 0; partition < level.numPartitions; ++partition)
+        {
+            std::fill(designBuffer.begin(), designBuffer.end(), 0.0f);
+            std::copy_n(taps + level.firstTap + partition * level.blockSize, level.blockSize, designBuffer.begin());
+
+            level.designFFT->performRealOnlyForwardTransform(designBuffer.data(), true);
+            std::copy_n(designBuffer.begin(), spectrumSize,
+                        kernel.spectra.begin() + static_cast<std::ptrdiff_t>(level.kernelOffset + (size_t)partition * spectrumSize));
+        }
+    }
+}
+
+void NonUniformConvolver::setKernel(Kernel* kernel) noexcept
+{
+    current = kernel;
+    outgoing = nullptr;
+}
+
+void NonUniformConvolver::startWorker()
+{
+    startThread(juce::Thread::Priority::highest);
+}
+
+void NonUniformConvolver::stopWorker()
+{
+    stopThread(1000);
+}
+
+void NonUniformConvolver::reset() noexcept
+{
+    for (int index = 1; index < numLevels; ++index)
+        settleTask(levels[(size_t)index]);
+
+    // A job the worker is still running keeps the spectra it was queued with; each level's
+    // recent spectra are replaced by cleared ones from the rest.
+    for (int index = 0; index < numLevels; ++index)
+    {
+        auto& level = levels[(size_t)index];
+
+        for (size_t cleared = 0; cleared < level.recent.size(); ++cleared)
+            clearSpectrum(level, pushSpectrum(level));
+
+        std::fill(level.outputs.begin(), level.outputs.end(), 0.0f);
+    }
+
+    std::fill(history.begin(), history.end(), 0.0f);
+    clock = 0;
+
+    // Nothing is left to fade from; the outgoing kernel is handed back at the first chance.
+    if (outgoing != nullptr)
+        swapTime = -static_cast<juce::int64>(maxBlockSize + fadeLength);
+}
+
+void NonUniformConvolver::run()
+{
+    while (!threadShouldExit())
+    {
+        bool ranTask = false;
+
+        // Smallest blocks first: theirs are the nearest deadlines.
+        for (int index = 1; index < numLevels && !ranTask; ++index)
+        {
+            auto& level = levels[(size_t)index];
+
+            for (auto& job : level.jobs)
+            {
+                auto expected = static_cast<int>(taskQueued);
+
+                if (!job.state.compare_exchange_strong(expected, taskRunning, std::memory_order_acq_rel))
+                    continue;
+
+                runJob(level, job);
+
+                // Dropped by the audio thread meanwhile: the job is free again.
+                expected = taskRunning;
+
+                if (!job.state.compare_exchange_strong(expected, taskDone, std::memory_order_acq_rel))
+                    job.state.store(taskIdle, std::memory_order_release);
+
+                ranTask = true;
+                break;
+            }
+        }
+
+        if (!ranTask)
+            wait(-1);
+    }
+}
+
+void NonUniformConvolver::renderChunk(int channel, const float* input, int count) noexcept
+{
+    const Kernel* from = nullptr;
+    const Kernel* to = nullptr;
+    chooseKernels(clock, count, from, to);
+
+    auto* output = chunkBuffer.data();
+    runDirectForm(to->directTaps.data(), input, output, count);
+
+    if (from != nullptr)
+    {
+        auto* faded = fadeChunkBuffer.data();
+        runDirectForm(from->directTaps.data(), input, faded, count);
+
+        for (int i = 0; i < count; ++i)
+            output[i] = faded[i] + (output[i] - faded[i]) * getFadeGain(clock + i, swapTime);
+    }
+
+    for (int index = 0; index < numLevels; ++index)
+    {
+        const auto& level = levels[(size_t)index];
+        const auto offset = static_cast<int>(clock & (level.blockSize - 1));
+        const auto* levelOutput = level.outputs.data() + (size_t)(channel * level.blockSize + offset);
+
+        juce::FloatVectorOperations::add(output, levelOutput, count);
+    }
+}
+
+void NonUniformConvolver::processBoundary(int numChannels) noexcept
+{
+    if ((clock & (maxBlockSize - 1)) == 0)
+        updateKernels();
+
+    // Level 0 computes the block that starts now.
+    auto& first = levels[0];
+    auto& firstJob = first.jobs[0];
+    captureFrames(first, firstJob, numChannels);
+    chooseKernels(clock, first.blockSize, firstJob.task.from, firstJob.task.to);
+    firstJob.task.blockStart = clock;
+    firstJob.task.swapTime = swapTime;
+    firstJob.task.numChannels = numChannels;
+    std::copy(first.recent.begin(), first.recent.end(), firstJob.recent.begin());
+    runJob(first, firstJob);
+    storeJob(first, firstJob);
+
+    // The worker's levels queue the block after the one that starts now.
+    bool queued = false;
+
+    for (int index = 1; index < numLevels; ++index)
+    {
+        auto& level = levels[(size_t)index];
+
+        if ((clock & (level.blockSize - 1)) != 0)
+            continue;
+
+        completeTask(level);
+
+        // The worker runs one job at a time, so at most one per level is still busy with a
+        // dropped block and the other is free.
+        auto* job = &level.jobs[0];
+
+        if (job->state.load(std::memory_order_acquire) != taskIdle)
+            job = &level.jobs[1];
+
+        jassert(job->state.load(std::memory_order_acquire) == taskIdle);
+        captureFrames(level, *job, numChannels);
+
+        auto& task = job->task;
+        task.blockStart = clock + level.blockSize;
+        chooseKernels(task.blockStart, level.blockSize, task.from, task.to);
+        task.swapTime = swapTime;
+        task.numChannels = numChannels;
+        std::copy(level.recent.begin(), level.recent.end(), job->recent.begin());
+
+        level.queued = job;
+
+        // Due before this callback ends, so before the worker could help.
+        if (nonRealtime || task.blockStart <= callbackEnd)
+        {
+            runJob(level, *job);
+            job->state.store(taskDone, std::memory_order_relaxed);
+            continue;
+        }
+
+        job->state.store(taskQueued, std::memory_order_release);
+        queued = true;
+    }
+
+    if (queued)
+        notify();
+}
+
+void NonUniformConvolver::updateKernels() noexcept
+{
+    // Every block that could still use the outgoing kernel started before now, but a dropped
+    // one may still be running on the worker.
+    if (outgoing != nullptr && clock >= swapTime + maxBlockSize && !isKernelInUse(outgoing)
+        && returned.load(std::memory_order_acquire) == nullptr)
+    {
+        returned.store(outgoing, std::memory_order_release);
+        outgoing = nullptr;
+    }
+
+    if (outgoing == nullptr && pending.load(std::memory_order_relaxed) != nullptr)
+    {
+        if (auto* fresh = pending.exchange(nullptr, std::memory_order_acq_rel))
+        {
+            outgoing = current;
+            current = fresh;
+
+            // The largest level is already computing the block up to here with the old one.
+            swapTime = clock + maxBlockSize;
+        }
+    }
+}
+
+void NonUniformConvolver::chooseKernels(juce::int64 blockStart, int length, const Kernel*& from,
+    const Kernel*& to) const noexcept
+{
+    from = nullptr;
+    to = current;
+
+    if (outgoing == nullptr)
+        return;
+
+    if (blockStart + length <= swapTime)
+        to = outgoing;
+    else if (blockStart < swapTime + fadeLength)
+        from = outgoing;
+}
+
+float NonUniformConvolver::getFadeGain(juce::int64 time, juce::int64 fadeStart) const noexcept
+{
+    return juce::jlimit(0.0f, 1.0f, static_cast<float>(time - fadeStart + 1) / static_cast<float>(fadeLength));
+}
+
+void NonUniformConvolver::captureFrames(const Level& level, Job& job, int numChannels) noexcept
+{
+    const auto frameLength = 2 * level.blockSize;
+    const auto position = static_cast<int>(clock & (historyLength - 1));
+
+    for (int ch = 0; ch < numChannels; ++ch)
+        std::copy_n(getHistory(ch) + position + historyLength - frameLength, frameLength,
+                    job.frames.data() + (size_t)(ch * frameLength));
+}
+
+void NonUniformConvolver::runJob(Level& level, Job& job) noexcept
+{
+    const auto& task = job.task;
+    const auto blockSize = level.blockSize;
+    const auto transformSize = 2 * blockSize;
+    const auto spectrumSize = 2 * level.numBins;
+    auto* transform = job.transform.data();
+
+    for (int ch = 0; ch < task.numChannels; ++ch)
+    {
+        std::copy_n(job.frames.data() + (size_t)(ch * transformSize), transformSize, transform);
+        std::fill(job.transform.begin() + transformSize, job.transform.end(), 0.0f);
+        job.fft->performRealOnlyForwardTransform(transform, true);
+        std::copy_n(transform, spectrumSize, job.spectra.data() + (size_t)(ch * spectrumSize));
+
+        // Overlap-save: the first half of the frame is circular wrap-around, the second
+        // half is the block's output.
+        auto* output = job.outputs.data() + (size_t)(ch * blockSize);
+
+        if (!accumulate(level, job, *task.to, ch))
+            return;
+
+        std::copy_n(job.accumulator.data(), spectrumSize, transform);
+        job.fft->performRealOnlyInverseTransform(transform);
+        std::copy_n(transform + blockSize, blockSize, output);
+
+        if (task.from != nullptr)
+        {
+            if (!accumulate(level, job, *task.from, ch))
+                return;
+
+            std::copy_n(job.accumulator.data(), spectrumSize, transform);
+            job.fft->performRealOnlyInverseTransform(transform);
+            std::copy_n(transform + blockSize, blockSize, job.fade.data());
+
+            for (int i = 0; i < blockSize; ++i)
+            {
+                const auto faded = job.fade[(size_t)i];
+                output[i] = faded + (output[i] - faded) * getFadeGain(task.blockStart + i, task.swapTime);
+            }
+        }
+    }
+}
+
+// Returns false, leaving the sum unfinished, once the job has been dropped.
+bool NonUniformConvolver::accumulate(const Level& level, Job& job, const Kernel& kernel, int channel) noexcept
+{
+    const auto spectrumSize = 2 * level.numBins;
+    auto* sum = job.accumulator.data();
+    std::fill(job.accumulator.begin(), job.accumulator.end(), 0.0f);
+
+    // Partition 0 meets the job's own input spectrum, partition p the one from p blocks ago.
+    for (int partition = 0; partition < level.numPartitions; ++partition)
+    {
+        if (job.state.load(std::memory_order_relaxed) == taskAbandoned)
+            return false;
+
+        const auto* x = partition == 0
+            ? job.spectra.data() + (size_t)(channel * spectrumSize)
+            : level.spectra.data() + getSpectrumOffset(level, job.recent[(size_t)(partition - 1)], channel);
+
+        const auto* h = kernel.spectra.data() + level.kernelOffset + (size_t)(partition * spectrumSize);
+
+        for (int i = 0; i < spectrumSize; i += 2)
+        {
+            sum[i] += x[i] * h[i] - x[i + 1] * h[i + 1];
+            sum[i + 1] += x[i] * h[i + 1] + x[i + 1] * h[i];
+        }
+    }
+
+    return true;
+}
+
+// Plays a finished job's block and files its input spectrum for the blocks after it.
+void NonUniformConvolver::storeJob(Level& level, Job& job) noexcept
+{
+    // Freed first, so the oldest spectrum it read can be reused.
+    job.state.store(taskIdle, std::memory_order_release);
+
+    const auto spectrumSize = 2 * level.numBins;
+    const auto buffer = pushSpectrum(level);
+
+    for (int ch = 0; ch < job.task.numChannels; ++ch)
+    {
+        if (buffer >= 0)
+            std::copy_n(job.spectra.data() + (size_t)(ch * spectrumSize), spectrumSize,
+                        level.spectra.data() + getSpectrumOffset(level, buffer, ch));
+
+        std::copy_n(job.outputs.data() + (size_t)(ch * level.blockSize), level.blockSize,
+                    level.outputs.data() + (size_t)(ch * level.blockSize));
+    }
+}
+
+// Stands in for a block the worker did not finish in time: the level plays silence for it,
+// and the block's input counts as silence in the level's later partitions too.
+void NonUniformConvolver::skipBlock(Level& level) noexcept
+{
+    missedBlocks.fetch_add(1, std::memory_order_relaxed);
+    clearSpectrum(level, pushSpectrum(level));
+    std::fill(level.outputs.begin(), level.outputs.end(), 0.0f);
+}
+
+// Called when the block a level queued is due. The audio thread does not compute a block
+// it left to the worker, nor wait for it: one the worker has not finished is dropped,
+// whether or not it started, so the work here stays the same however late the worker is.
+void NonUniformConvolver::completeTask(Level& level) noexcept
+{
+    auto* job = level.queued;
+
+    if (job == nullptr)
+        return;
+
+    level.queued = nullptr;
+
+    if (withdrawJob(*job))
+        storeJob(level, *job);
+    else
+        skipBlock(level);
+}
+
+// Drops a level's queued or running block, so the level can be cleared. A running one is
+// left to the worker, which frees it when done.
+void NonUniformConvolver::settleTask(Level& level) noexcept
+{
+    level.queued = nullptr;
+
+    for (auto& job : level.jobs)
+        if (withdrawJob(job))
+            job.state.store(taskIdle, std::memory_order_release);
+}
+
+// Takes a job back from the worker: a queued one becomes idle, a running one is marked
+// abandoned for the worker to free. Returns true if it had already finished, in which case
+// the caller frees it.
+bool NonUniformConvolver::withdrawJob(Job& job) noexcept
+{
+    auto state = job.state.load(std::memory_order_acquire);
+
+    for (;;)
+    {
+        if (state == taskDone)
+            return true;
+
+        if (state != taskQueued && state != taskRunning)
+            return false;
+
+        const auto next = state == taskQueued ? taskIdle : taskAbandoned;
+
+        if (job.state.compare_exchange_weak(state, next, std::memory_order_acq_rel))
+            return false;
+    }
+}
+
+// Makes a spectrum buffer no job lists the level's newest, and returns it; -1 if the level
+// keeps none. The oldest recent one drops out, and so is free unless a job still lists it.
+int NonUniformConvolver::pushSpectrum(Level& level) noexcept
+{
+    if (level.recent.empty())
+        return -1;
+
+    auto isListed = [&level](int buffer)
+    {
+        if (std::find(level.recent.begin(), level.recent.end() - 1, buffer) != level.recent.end() - 1)
+            return true;
+
+        for (const auto& job : level.jobs)
+            if (job.state.load(std::memory_order_acquire) != taskIdle
+                && std::find(job.recent.begin(), job.recent.end(), buffer) != job.recent.end())
+                return true;
+
+        return false;
+    };
+
+    auto buffer = 0;
+
+    while (buffer < level.numSpectra && isListed(buffer))
+        ++buffer;
+
+    // Only reachable if more than one job per level were left running.
+    jassert(buffer < level.numSpectra);
+    buffer = juce::jmin(buffer, level.numSpectra - 1);
+
+    std::rotate(level.recent.begin(), level.recent.end() - 1, level.recent.end());
+    level.recent.front() = buffer;
+    return buffer;
+}
+
+void NonUniformConvolver::clearSpectrum(Level& level, int buffer) noexcept
+{
+    if (buffer < 0)
+        return;
+
+    const auto start = level.spectra.begin() + static_cast<std::ptrdiff_t>(getSpectrumOffset(level, buffer, 0));
+    std::fill(start, start + static_cast<std::ptrdiff_t>(getSpectrumOffset(level, 1, 0)), 0.0f);
+}
+
+bool NonUniformConvolver::isKernelInUse(const Kernel* kernel) const noexcept
+{
+    for (int index = 1; index < numLevels; ++index)
+        for (const auto& job : levels[(size_t)index].jobs)
+            if (job.state.load(std::memory_order_acquire) != taskIdle
+                && (job.task.to == kernel || job.task.from == kernel))
+                return true;
+
+    return false;
+}
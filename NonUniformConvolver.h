@@ -0,0 +1,244 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Convolution with a long FIR and no added latency, partitioned non-uniformly after
+// Gardner, "Efficient Convolution without Input-Output Delay":
+//
+// - taps 0-63 run as a direct-form FIR, sample by sample;
+// - taps 64-511 as 64-sample partitions, transformed on the audio thread every 64 samples;
+// - the rest as 256-, 1024- and 2048-sample partitions, transformed on a worker thread.
+//
+// A level of B-sample partitions starts 2B taps in. Its transform can be queued as soon as
+// a block of B input samples is complete, and the result is needed only one block later:
+// that block is the worker's time to compute it. So with short callbacks the audio thread
+// does the same small amount of work every 64 samples whatever the FIR length, and the
+// large transforms never land in a single callback.
+//
+// A block due within the callback that queues it gives the worker no time at all, so the
+// audio thread computes it there and then, as does every block while rendering offline.
+// That happens only in callbacks at least B samples long, and costs per sample what any
+// partitioned convolution does. The rest is the worker's alone: the audio thread never
+// runs it nor waits for it, so its work stays bounded however late the worker is. A block
+// the worker has not finished by its deadline is dropped and its level plays silence for
+// it; the block's input drops out of the level's later partitions as well, and
+// getMissedBlocks() counts these.
+//
+// Kernels are swapped without clicks: one offered by another thread is taken at a
+// 2048-sample boundary, every level switches to it 2048 samples later (the furthest ahead
+// any level computes), and the output fades from the old kernel to the new over 512
+// samples. The old kernel is handed back once nothing can still be using it.
+class NonUniformConvolver : private juce::Thread
+{
+public:
+    static constexpr int directLength = 64;
+
+    // One FIR split and transformed for every level.
+    struct Kernel
+    {
+        std::array<float, directLength> directTaps{};
+        std::vector<float> spectra;   // every level's partitions, interleaved complex
+    };
+
+    NonUniformConvolver();
+    ~NonUniformConvolver() override;
+
+    // Lays out the levels for an FIR of the given length (a power of two, at least 4096)
+    // and allocates. Stops the worker.
+    void prepare(int filterLength, int numChannels);
+
+    void allocateKernel(Kernel& kernel) const;
+
+    // Splits and transforms an FIR of the prepared length. Not for the audio thread, and
+    // calls must not overlap.
+    void fillKernel(const float* taps, Kernel& kernel);
+
+    // The kernel used until the first swap; set while nothing is processing.
+    void setKernel(Kernel* kernel) noexcept;
+
+    // Hand-off with the thread that fills kernels. Offering returns the previous offer if
+    // the audio thread had not taken it yet; kernels the audio thread has finished with
+    // come back through takeReturned().
+    Kernel* offerKernel(Kernel* kernel) noexcept { return pending.exchange(kernel, std::memory_order_acq_rel); }
+    Kernel* takeReturned() noexcept { return returned.exchange(nullptr, std::memory_order_acq_rel); }
+
+    void startWorker();
+    void stopWorker();
+
+    void reset() noexcept;
+
+    // Offline, callbacks come faster than real time and the worker could never keep up, so
+    // the audio thread computes every block itself. Audio thread.
+    void setNonRealtime(bool shouldBeNonRealtime) noexcept { nonRealtime = shouldBeNonRealtime; }
+
+    // Worker blocks dropped at their deadline since prepare(); readable from any thread.
+    int getMissedBlocks() const noexcept { return missedBlocks.load(std::memory_order_relaxed); }
+
+    // Filters the block in place. While bypassed the output is the input delayed by half
+    // the FIR, the latency of a linear-phase kernel; the convolution keeps running, so
+    // coming out of bypass is seamless.
+    template <typename SampleType>
+    void process(const juce::dsp::AudioBlock<SampleType>& block, bool bypassed) noexcept
+    {
+        if (current == nullptr)
+            return;
+
+        const auto numChannels = juce::jmin(static_cast<int>(block.getNumChannels()), preparedChannels);
+        const auto numSamples = static_cast<int>(block.getNumSamples());
+        callbackEnd = clock + numSamples;
+
+        // Chunks end on 64-sample boundaries, which also keeps each one contiguous in the
+        // mirrored input history.
+        for (int start = 0; start < numSamples;)
+        {
+            const auto phase = static_cast<int>(clock & (directLength - 1));
+            const auto count = juce::jmin(numSamples - start, directLength - phase);
+            const auto writePosition = static_cast<int>(clock & (historyLength - 1));
+
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                auto* data = block.getChannelPointer(static_cast<size_t>(ch)) + static_cast<size_t>(start);
+                auto* input = getHistory(ch) + writePosition;
+
+                for (int i = 0; i < count; ++i)
+                    input[i] = input[i + historyLength] = static_cast<float>(data[i]);
+
+                const auto* output = input + historyLength - dryDelay;
+
+                if (!bypassed)
+                {
+                    renderChunk(ch, input + historyLength, count);
+                    output = chunkBuffer.data();
+                }
+
+                for (int i = 0; i < count; ++i)
+                    data[i] = static_cast<SampleType>(output[i]);
+            }
+
+            start += count;
+            clock += count;
+
+            if ((clock & (directLength - 1)) == 0)
+                processBoundary(numChannels);
+        }
+    }
+
+private:
+    static constexpr int maxLevels = 4;
+    static constexpr int fadeLength = 512;
+
+    enum TaskState
+    {
+        taskIdle,
+        taskQueued,
+        taskRunning,
+        taskDone,
+        taskAbandoned   // still running on the worker, but its result is no longer wanted
+    };
+
+    // Everything a level needs to compute one output block, fixed when it is queued.
+    struct Task
+    {
+        const Kernel* from{ nullptr };   // set while fading from the previous kernel
+        const Kernel* to{ nullptr };
+        juce::int64 blockStart{ 0 };
+        juce::int64 swapTime{ 0 };
+        int numChannels{ 0 };
+    };
+
+    // One output block of a level, with its own input, scratch space and transform (an FFT
+    // object may lock while it runs). Of the level's state it only reads the stored spectra
+    // listed in recent; the audio thread stores the results.
+    struct Job
+    {
+        Task task;
+        std::vector<int> recent;   // the level's recent spectra when it was queued
+        std::unique_ptr<juce::dsp::FFT> fft;
+        std::vector<float> frames;    // per channel: the last two blocks of input
+        std::vector<float> spectra;   // per channel: the spectrum of those frames
+        std::vector<float> outputs;   // per channel: the output block
+        std::vector<float> transform;
+        std::vector<float> accumulator;
+        std::vector<float> fade;
+        std::atomic<int> state{ taskIdle };
+    };
+
+    // Partitions of one size. Level 0 runs inline on the audio thread, the others mostly on
+    // the worker. A job dropped at its deadline may still be running, so each level has a
+    // second one to queue the next block in.
+    struct Level
+    {
+        int blockSize{ 0 };
+        int numPartitions{ 0 };
+        int numBins{ 0 };
+        int firstTap{ 0 };
+        int numSpectra{ 0 };
+        size_t kernelOffset{ 0 };
+
+        std::unique_ptr<juce::dsp::FFT> designFFT;   // fillKernel() only
+
+        // Past input spectra, each for every channel, and which of them are the level's last
+        // numPartitions - 1, newest first. A buffer is only written while no job lists it,
+        // so a dropped job still running on the worker reads what it was queued with. It
+        // pins at most numPartitions - 1 of them, hence twice that plus one to fill.
+        std::vector<float> spectra;
+        std::vector<int> recent;
+        std::vector<float> outputs;   // per channel: the output block playing now
+
+        std::array<Job, 2> jobs;
+        Job* queued{ nullptr };   // audio thread only
+    };
+
+    void run() override;
+    void renderChunk(int channel, const float* input, int count) noexcept;
+    void processBoundary(int numChannels) noexcept;
+    void updateKernels() noexcept;
+    void chooseKernels(juce::int64 blockStart, int length, const Kernel*& from, const Kernel*& to) const noexcept;
+    float getFadeGain(juce::int64 time, juce::int64 fadeStart) const noexcept;
+    void captureFrames(const Level& level, Job& job, int numChannels) noexcept;
+    void runJob(Level& level, Job& job) noexcept;
+    bool accumulate(const Level& level, Job& job, const Kernel& kernel, int channel) noexcept;
+    void storeJob(Level& level, Job& job) noexcept;
+    void skipBlock(Level& level) noexcept;
+    void completeTask(Level& level) noexcept;
+    void settleTask(Level& level) noexcept;
+    static bool withdrawJob(Job& job) noexcept;
+    int pushSpectrum(Level& level) noexcept;
+    void clearSpectrum(Level& level, int buffer) noexcept;
+    bool isKernelInUse(const Kernel* kernel) const noexcept;
+
+    size_t getSpectrumOffset(const Level& level, int buffer, int channel) const noexcept
+    {
+        return ((size_t)buffer * (size_t)preparedChannels + (size_t)channel) * (size_t)(2 * level.numBins);
+    }
+
+    float* getHistory(int channel) noexcept
+    {
+        return history.data() + (size_t)channel * (size_t)(2 * historyLength);
+    }
+
+    int preparedChannels{ 0 };
+    int numLevels{ 0 };
+    int maxBlockSize{ directLength };
+    int dryDelay{ 0 };
+    int historyLength{ 0 };   // a power of two; stored twice so any span of it is contiguous
+
+    std::array<Level, maxLevels> levels;
+    std::vector<float> history;
+    std::vector<float> chunkBuffer;
+    std::vector<float> fadeChunkBuffer;
+    std::vector<float> designBuffer;
+    juce::int64 clock{ 0 };
+    juce::int64 callbackEnd{ 0 };
+    bool nonRealtime{ false };
+
+    Kernel* current{ nullptr };
+    Kernel* outgoing{ nullptr };
+    juce::int64 swapTime{ 0 };
+
+    std::atomic<Kernel*> pending{ nullptr };
+    std::atomic<Kernel*> returned{ nullptr };
+    std::atomic<int> missedBlocks{ 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(NonUniformConvolver)
+};
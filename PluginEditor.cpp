@@ -351,10 +351,15 @@ DynamicFilterProcessorEditor::DynamicFilterProcessorEditor(DynamicFilterProcesso
     typeLabel.setColour(juce::Label::textColourId, juce::Colours::white);
 
     addAndMakeVisible(slopeComboBox);
-    slopeComboBox.addItem("12 dB/oct", 1);
-    slopeComboBox.addItem("24 dB/oct", 2);
-    slopeComboBox.addItem("36 dB/oct", 3);
-    slopeComboBox.addItem("48 dB/oct", 4);
+    // The attachment maps choices to item indices, so the items follow the parameter's
+    // order: the even orders, then the odd ones appended after them. Headings are not items
+    // and leave the indices alone.
+    slopeComboBox.addSectionHeading("Even Orders");
+    for (int order = 2; order <= 16; order += 2)
+        slopeComboBox.addItem(juce::String(order * 6) + " dB/oct", order / 2);
+    slopeComboBox.addSectionHeading("Odd Orders");
+    for (int order = 1; order <= 15; order += 2)
+        slopeComboBox.addItem(juce::String(order * 6) + " dB/oct", 9 + order / 2);
     slopeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
         audioProcessor.apvts, "slope", slopeComboBox);
 
@@ -375,6 +380,17 @@ DynamicFilterProcessorEditor::DynamicFilterProcessorEditor(DynamicFilterProcesso
     characteristicLabel.setJustificationType(juce::Justification::centredLeft);
     characteristicLabel.setColour(juce::Label::textColourId, juce::Colours::white);
 
+    addAndMakeVisible(engineComboBox);
+    engineComboBox.addItem("Biquad", 1);
+    engineComboBox.addItem("State Variable", 2);
+    engineAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+        audioProcessor.apvts, "engine", engineComboBox);
+
+    addAndMakeVisible(engineLabel);
+    engineLabel.setText("Engine", juce::dontSendNotification);
+    engineLabel.setJustificationType(juce::Justification::centredLeft);
+    engineLabel.setColour(juce::Label::textColourId, juce::Colours::white);
+
     addAndMakeVisible(bypassButton);
     bypassAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(
         audioProcessor.apvts, "bypass", bypassButton);
@@ -485,7 +501,7 @@ void DynamicFilterProcessorEditor::resized()
     controlsArea.removeFromTop(10);
 
     auto comboArea = controlsArea.removeFromTop(60);
-    int comboWidth = comboArea.getWidth() / 3;
+    int comboWidth = comboArea.getWidth() / 4;
 
     auto typeArea = comboArea.removeFromLeft(comboWidth).reduced(5);
     typeLabel.setBounds(typeArea.removeFromTop(20));
@@ -495,10 +511,14 @@ void DynamicFilterProcessorEditor::resized()
     slopeLabel.setBounds(slopeArea.removeFromTop(20));
     slopeComboBox.setBounds(slopeArea);
 
-    auto charArea = comboArea.reduced(5);
+    auto charArea = comboArea.removeFromLeft(comboWidth).reduced(5);
     characteristicLabel.setBounds(charArea.removeFromTop(20));
     characteristicComboBox.setBounds(charArea);
 
+    auto engineArea = comboArea.reduced(5);
+    engineLabel.setBounds(engineArea.removeFromTop(20));
+    engineComboBox.setBounds(engineArea);
+
     controlsArea.removeFromTop(10);
 
     auto bottomArea = controlsArea.removeFromTop(40);
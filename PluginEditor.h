@@ -139,6 +139,10 @@ private:
     juce::Label characteristicLabel;
     std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> characteristicAttachment;
 
+    juce::ComboBox engineComboBox;
+    juce::Label engineLabel;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> engineAttachment;
+
     juce::ToggleButton bypassButton{ "Bypass" };
     std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> bypassAttachment;
 
@@ -7,6 +7,7 @@ DynamicFilterProcessor::DynamicFilterProcessor()
 #if ! JucePlugin_IsMidiEffect
 #if ! JucePlugin_IsSynth
         .withInput("Input", juce::AudioChannelSet::stereo(), true)
+        .withInput("Sidechain", juce::AudioChannelSet::stereo(), false)
 #endif
         .withOutput("Output", juce::AudioChannelSet::stereo(), true)
 #endif
@@ -14,17 +15,54 @@ DynamicFilterProcessor::DynamicFilterProcessor()
 #endif
     , apvts(*this, nullptr, "Parameters", createParameterLayout())
 {
+    filterParameters.bypass = apvts.getRawParameterValue("bypass");
+    filterParameters.cutoff = apvts.getRawParameterValue("cutoff");
+    filterParameters.q = apvts.getRawParameterValue("q");
+    filterParameters.resonance = apvts.getRawParameterValue("resonance");
+    filterParameters.type = apvts.getRawParameterValue("type");
+    filterParameters.slope = apvts.getRawParameterValue("slope");
+    filterParameters.characteristic = apvts.getRawParameterValue("characteristic");
+    filterParameters.engine = apvts.getRawParameterValue("engine");
+    filterParameters.design = apvts.getRawParameterValue("design");
+    filterParameters.channelMode = apvts.getRawParameterValue("channelMode");
+    filterParameters.sideCutoff = apvts.getRawParameterValue("sideCutoff");
+    filterParameters.cutoffBypass = apvts.getRawParameterValue("cutoffBypass");
+    filterParameters.qBypass = apvts.getRawParameterValue("qBypass");
+    filterParameters.resonanceBypass = apvts.getRawParameterValue("resonanceBypass");
+    filterParameters.crossfade = apvts.getRawParameterValue("crossfade");
+    filterParameters.oversampling = apvts.getRawParameterValue("oversampling");
+    filterParameters.phase = apvts.getRawParameterValue("phase");
+    filterParameters.updateInterval = apvts.getRawParameterValue("updateInterval");
+
+    envelopeParameters.attack = apvts.getRawParameterValue("envAttack");
+    envelopeParameters.release = apvts.getRawParameterValue("envRelease");
+    envelopeParameters.threshold = apvts.getRawParameterValue("envThreshold");
+    envelopeParameters.depth = apvts.getRawParameterValue("envDepth");
+    envelopeParameters.source = apvts.getRawParameterValue("envSource");
+
+    for (int index = 0; index < numLfos; ++index)
+    {
+        const auto prefix = "lfo" + juce::String(index + 1);
+        auto& parameters = lfoParameters[(size_t)index];
+
+        parameters.shape = apvts.getRawParameterValue(prefix + "Shape");
+        parameters.rate = apvts.getRawParameterValue(prefix + "Rate");
+        parameters.target = apvts.getRawParameterValue(prefix + "Target");
+        parameters.depth = apvts.getRawParameterValue(prefix + "Depth");
+    }
 }
 
 DynamicFilterProcessor::~DynamicFilterProcessor()
 {
+    cancelPendingUpdate();
 }
 
 const juce::String DynamicFilterProcessor::getName() const { return JucePlugin_Name; }
 bool DynamicFilterProcessor::acceptsMidi() const { return false; }
 bool DynamicFilterProcessor::producesMidi() const { return false; }
 bool DynamicFilterProcessor::isMidiEffect() const { return false; }
-double DynamicFilterProcessor::getTailLengthSeconds() const { return 0.1; }
+bool DynamicFilterProcessor::supportsDoublePrecisionProcessing() const { return true; }
+double DynamicFilterProcessor::getTailLengthSeconds() const { return tailLengthSeconds.load(std::memory_order_relaxed); }
 int DynamicFilterProcessor::getNumPrograms() { return 1; }
 int DynamicFilterProcessor::getCurrentProgram() { return 0; }
 void DynamicFilterProcessor::setCurrentProgram(int) {}
@@ -35,42 +73,112 @@ void DynamicFilterProcessor::prepareToPlay(double sampleRate, int samplesPerBloc
 {
     currentSampleRate = sampleRate;
 
-    juce::dsp::ProcessSpec spec;
-    spec.sampleRate = sampleRate;
-    spec.maximumBlockSize = static_cast<juce::uint32>(samplesPerBlock);
-    spec.numChannels = 1;
+    for (int index = 0; index <= maxOversamplingIndex; ++index)
+        prewarpTables[(size_t)index].build(sampleRate * (1 << index));
+
+    // Channels are packed a register's width at a time (four floats or two doubles on
+    // SSE/NEON), so a 7.1.4 or third-order ambisonic bus runs as three or four float groups.
+    // The cascades are sized for the largest oversampled block.
+    int numChannels = juce::jmax(1, getMainBusNumInputChannels(), getMainBusNumOutputChannels());
+    int maxProcessingBlock = samplesPerBlock * (1 << maxOversamplingIndex);
+
+    for (auto& engines : floatEngines)
+        engines.prepare(maxProcessingBlock, numChannels);
+
+    for (auto& engines : doubleEngines)
+        engines.prepare(maxProcessingBlock, numChannels);
+
+    activeSlot = 0;
+    crossfadeLength = 0;
+    crossfadeRemaining = 0;
+
+    int initOversampling = juce::jlimit(0, maxOversamplingIndex,
+        static_cast<int>(*filterParameters.oversampling));
+
+    // Sized before the latency is first reported; if the mode is in use it allocates and
+    // designs once the snapshot below is set.
+    cancelPendingUpdate();
+    linearPhaseFilter.prepare(sampleRate, numChannels);
+    linearPhaseActive = *filterParameters.phase > 0.5f;
+    linearPhaseRequested = linearPhaseActive;
+
+    if (isUsingDoublePrecision())
+    {
+        prepareOversamplers<double>(numChannels, samplesPerBlock);
+        setOversampling<double>(initOversampling);
+    }
+    else
+    {
+        prepareOversamplers<float>(numChannels, samplesPerBlock);
+        setOversampling<float>(initOversampling);
+    }
+
+    smoothedCutoff.reset(sampleRate, smoothingSeconds);
+    smoothedQ.reset(sampleRate, smoothingSeconds);
+    smoothedResonance.reset(sampleRate, smoothingSeconds);
+    smoothedSideCutoff.reset(sampleRate, smoothingSeconds);
+    cutoffAutomated = qAutomated = resonanceAutomated = sideCutoffAutomated = false;
+
+    sidechainChannels = getBusCount(true) > 1 ? getChannelCountOfBus(true, 1) : 0;
+
+    // The detector reads the host-rate input or key, before any oversampling.
+    envelopeFollower.prepare(sampleRate);
+    currentEnvelopeShift = 0.0f;
+    envelopeSweeping = false;
+
+    // One LFO point per control interval, at the shortest interval.
+    int maxLfoPoints = samplesPerBlock / 16 + 1;
 
-    filterChainL.prepare(spec);
-    filterChainR.prepare(spec);
+    for (auto& modulation : lfoModulation)
+        modulation.assign(static_cast<size_t>(maxLfoPoints), 0.0f);
 
-    filterChainL.reset();
-    filterChainR.reset();
+    lfoOffsets.assign(static_cast<size_t>(maxLfoPoints), 0.0f);
+    lfoValues.assign(static_cast<size_t>(maxLfoPoints), 0.0f);
 
-    smoothedCutoff.reset(sampleRate, 0.02);
-    smoothedQ.reset(sampleRate, 0.02);
-    smoothedResonance.reset(sampleRate, 0.02);
+    for (auto& lfo : lfos)
+        lfo.reset();
 
-    float initCutoff = *apvts.getRawParameterValue("cutoff");
-    float initQ = *apvts.getRawParameterValue("q");
-    float initResonance = *apvts.getRawParameterValue("resonance");
+    currentLfoModulation = {};
+    lfoSweeping = false;
+
+    float initCutoff = *filterParameters.cutoff;
+    float initSideCutoff = *filterParameters.sideCutoff;
+    float initQ = *filterParameters.q;
+    float initResonance = *filterParameters.resonance;
 
     smoothedCutoff.setCurrentAndTargetValue(initCutoff);
     smoothedQ.setCurrentAndTargetValue(initQ);
     smoothedResonance.setCurrentAndTargetValue(initResonance);
+    smoothedSideCutoff.setCurrentAndTargetValue(initSideCutoff);
 
     currentCutoff = initCutoff;
+    currentSideCutoff = initSideCutoff;
     currentQ = initQ;
     currentResonance = initResonance;
 
     inputWaveformData.resize(waveformSize, 0.0f);
     outputWaveformData.resize(waveformSize, 0.0f);
+    inputCapture.assign(static_cast<size_t>(waveformCaptureLength), 0.0f);
+    captureLength = 0;
     waveformWritePos = 0;
 
     // Initialize visualizer state from APVTS
     visualizerActive.store(*apvts.getRawParameterValue("visualizerEnabled") > 0.5f,
         std::memory_order_relaxed);
 
-    updateFilterCoefficients();
+    currentEngine = previousEngine = static_cast<int>(*filterParameters.engine);
+    currentDesign = previousDesign = static_cast<int>(*filterParameters.design);
+    currentChannelMode = previousChannelMode = static_cast<int>(*filterParameters.channelMode);
+
+    updateFilterCoefficients(false);
+    publishResponseSnapshot();
+
+    if (linearPhaseActive)
+        linearPhaseFilter.beginDesigning();
+
+    idle = false;
+    wakingFromIdle = false;
+    silentSamples = 0;
 
     inputLevel.store(0.0f, std::memory_order_relaxed);
     outputLevel.store(0.0f, std::memory_order_relaxed);
@@ -82,194 +190,777 @@ void DynamicFilterProcessor::prepareToPlay(double sampleRate, int samplesPerBloc
 
 void DynamicFilterProcessor::releaseResources()
 {
+    cancelPendingUpdate();
+    linearPhaseFilter.stopDesigning();
+}
+
+// Sets up or winds down the linear-phase FIR off the audio thread, following whatever the
+// phase parameter says by the time this runs.
+void DynamicFilterProcessor::handleAsyncUpdate()
+{
+    if (*filterParameters.phase > 0.5f)
+        linearPhaseFilter.beginDesigning();
+    else
+        linearPhaseFilter.stopDesigning();
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
 bool DynamicFilterProcessor::isBusesLayoutSupported(const BusesLayout& layouts) const
 {
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-        && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // Every channel shares one coefficient set (mid/side aside, which only applies to a
+    // stereo pair), so any layout works: mono, stereo, surround, immersive or ambisonic,
+    // as long as input and output match.
+    const auto& outputSet = layouts.getMainOutputChannelSet();
+
+    if (outputSet.isDisabled() || outputSet.size() > maxChannels)
         return false;
 
 #if ! JucePlugin_IsSynth
     if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
         return false;
+
+    // The key only feeds the envelope follower, so mono or stereo covers it.
+    if (layouts.inputBuses.size() > 1)
+    {
+        const auto& keySet = layouts.getChannelSet(true, 1);
+
+        if (!keySet.isDisabled())
+        {
+            if (keySet != juce::AudioChannelSet::mono() && keySet != juce::AudioChannelSet::stereo())
+                return false;
+
+            if (outputSet.size() > maxChannelsWithSidechain)
+                return false;
+        }
+    }
 #endif
 
     return true;
 }
 #endif
 
-void DynamicFilterProcessor::updateFilterCoefficients()
+int DynamicFilterProcessor::getSlopeForChoice(int index) noexcept
+{
+    // Choices 0-7 are 12 to 96 dB/oct and 8-15 the odd orders, 6 to 90 dB/oct: each range
+    // was appended after the last, so saved sessions keep their slope.
+    index = juce::jlimit(0, 2 * maxStages - 1, index);
+    return index < maxStages ? (index + 1) * 12 : (index - maxStages) * 12 + 6;
+}
+
+// Only a stereo pair has a mid and a side; other layouts keep every channel as it is.
+bool DynamicFilterProcessor::usesMidSide(int channelMode) const noexcept
+{
+    return channelMode == CHANNELS_MID_SIDE && getTotalNumOutputChannels() == 2;
+}
+
+// Depth is reached at 0 dBFS and scales linearly with the level in dB above the threshold.
+float DynamicFilterProcessor::getEnvelopeShift(float envelope) const noexcept
+{
+    float depth = *envelopeParameters.depth;
+    float threshold = *envelopeParameters.threshold;
+    float level = juce::Decibels::gainToDecibels(envelope, threshold);
+
+    return depth * juce::jlimit(0.0f, 1.0f, (level - threshold) / -threshold);
+}
+
+double DynamicFilterProcessor::getLfoBeatsPerCycle(int index) noexcept
+{
+    // Note values in quarter notes, matching the "lfoRate" choices: T is a triplet, D dotted.
+    static constexpr double beats[] = { 0.125, 1.0 / 6.0, 0.25, 1.0 / 3.0, 0.375, 0.5, 2.0 / 3.0, 0.75,
+                                        1.0, 4.0 / 3.0, 1.5, 2.0, 8.0 / 3.0, 3.0, 4.0, 8.0, 16.0 };
+    return beats[juce::jlimit(0, static_cast<int>(std::size(beats)) - 1, index)];
+}
+
+// Fills lfoModulation with every target's summed modulation at the end of each control
+// interval of the block, and returns the spacing of those points in samples. Returns 0,
+// leaving it untouched, while no LFO has any depth.
+int DynamicFilterProcessor::renderLfos(int numSamples, int interval) noexcept
+{
+    // Full depth: four octaves of cutoff, two octaves of Q, 10 dB of resonance.
+    static constexpr float targetRanges[] = { 4.0f, 2.0f, 10.0f };
+
+    // Hosts may pass more samples than prepareToPlay announced; the points then span
+    // several intervals each, so every interval still finds one.
+    const int capacity = static_cast<int>(lfoOffsets.size());
+    int spacing = interval * ((numSamples + interval * capacity - 1) / (interval * capacity));
+    int numPoints = (numSamples + spacing - 1) / spacing;
+
+    bool anyActive = false;
+    double bpm = 120.0;
+    double ppq = 0.0;
+    bool synced = false;
+
+    for (int index = 0; index < numLfos; ++index)
+    {
+        const auto& parameters = lfoParameters[(size_t)index];
+        float depth = *parameters.depth;
+
+        if (depth == 0.0f)
+            continue;
+
+        if (!anyActive)
+        {
+            anyActive = true;
+
+            // Stopped transports still report a position, but a frozen one: the LFOs run
+            // freely at the host tempo until playback resumes.
+            if (auto* playHead = getPlayHead())
+            {
+                if (auto position = playHead->getPosition())
+                {
+                    if (auto hostBpm = position->getBpm())
+                        bpm = *hostBpm;
+
+                    if (auto hostPpq = position->getPpqPosition())
+                    {
+                        ppq = *hostPpq;
+                        synced = position->getIsPlaying();
+                    }
+                }
+            }
+
+            for (int point = 0; point < numPoints; ++point)
+                lfoOffsets[(size_t)point] = static_cast<float>(juce::jmin(numSamples, (point + 1) * spacing));
+
+            for (auto& modulation : lfoModulation)
+                std::fill(modulation.begin(), modulation.begin() + numPoints, 0.0f);
+        }
+
+        double beatsPerCycle = getLfoBeatsPerCycle(static_cast<int>(*parameters.rate));
+        double cyclesPerSample = bpm / (60.0 * beatsPerCycle * currentSampleRate);
+        auto shape = static_cast<LfoShape>(juce::jlimit(0, 4, static_cast<int>(*parameters.shape)));
+        int target = juce::jlimit(0, numLfoTargets - 1, static_cast<int>(*parameters.target));
+
+        lfos[(size_t)index].process(shape, cyclesPerSample, synced, ppq / beatsPerCycle,
+                                    lfoOffsets.data(), lfoValues.data(), numPoints, numSamples);
+
+        juce::FloatVectorOperations::addWithMultiply(lfoModulation[(size_t)target].data(), lfoValues.data(),
+                                                     depth * targetRanges[target], numPoints);
+    }
+
+    return anyActive ? spacing : 0;
+}
+
+// Starts a glide to a new target from wherever the smoother is now. A one-off change takes
+// minSteps, so a step stays a step whatever the block size. A target that also moved in the
+// last block is being automated continuously: the wrappers apply each parameter's last
+// automation point in the block before calling us, so the value belongs at the block's end,
+// and gliding across exactly the block lands on it there, however short the block; a glide
+// held to minSteps would trail the automation by up to 20 ms. The control intervals sample
+// that glide and the coefficients interpolate between them, so a host's ramp is followed
+// sample by sample rather than as a staircase of 20 ms glides.
+//
+// LinearSmoothedValue only takes a new length through reset(), which also jumps to the
+// target, so the current value is restored first.
+void DynamicFilterProcessor::glideTo(juce::LinearSmoothedValue<float>& smoother, bool& automated, float target,
+                                     int blockSamples, int minSteps) noexcept
+{
+    bool moved = target != smoother.getTargetValue();
+    int numSteps = moved && automated ? juce::jmax(1, blockSamples) : minSteps;
+    automated = moved;
+
+    if (!moved)
+        return;
+
+    float current = smoother.getCurrentValue();
+    smoother.reset(numSteps);
+    smoother.setCurrentAndTargetValue(current);
+    smoother.setTargetValue(target);
+}
+
+int DynamicFilterProcessor::getUpdateInterval() const
+{
+    static constexpr int intervals[] = { 16, 32, 64 };
+    int index = juce::jlimit(0, 2, static_cast<int>(*filterParameters.updateInterval));
+    return intervals[index];
+}
+
+void DynamicFilterProcessor::updateFilterCoefficients(bool rampToNewValues)
 {
     float cutoff = currentCutoff;
+    float sideCutoff = currentSideCutoff;
     float q = currentQ;
     float resonance = currentResonance;
     int type = currentType;
-    int slopeIndex = currentSlope / 12 - 1;
     int characteristic = currentCharacteristic;
 
-    bool cutoffBypass = *apvts.getRawParameterValue("cutoffBypass") > 0.5f;
-    bool qBypass = *apvts.getRawParameterValue("qBypass") > 0.5f;
-    bool resonanceBypass = *apvts.getRawParameterValue("resonanceBypass") > 0.5f;
+    bool cutoffBypass = *filterParameters.cutoffBypass > 0.5f;
+    bool qBypass = *filterParameters.qBypass > 0.5f;
+    bool resonanceBypass = *filterParameters.resonanceBypass > 0.5f;
 
-    if (cutoffBypass) cutoff = 1000.0f;
+    if (cutoffBypass) cutoff = sideCutoff = 1000.0f;
     if (qBypass) q = 0.707f;
     if (resonanceBypass) resonance = 0.0f;
 
-    int slope = (slopeIndex + 1) * 12;
-    int numStages = slope / 12;
-    numStages = juce::jmin(numStages, 4);
+    float cutoffShift = currentEnvelopeShift + currentLfoModulation[LFO_CUTOFF];
+
+    if (cutoffShift != 0.0f)
+    {
+        float scale = std::exp2(cutoffShift);
+        cutoff = juce::jlimit(20.0f, 20000.0f, cutoff * scale);
+        sideCutoff = juce::jlimit(20.0f, 20000.0f, sideCutoff * scale);
+    }
+
+    if (currentLfoModulation[LFO_Q] != 0.0f)
+        q = juce::jlimit(0.1f, 10.0f, q * std::exp2(currentLfoModulation[LFO_Q]));
+
+    if (currentLfoModulation[LFO_RESONANCE] != 0.0f)
+        resonance = juce::jlimit(-10.0f, 10.0f, resonance + currentLfoModulation[LFO_RESONANCE]);
+
+    // 6 dB/oct per order. High- and low-pass odd orders end on a first-order section;
+    // band-pass and notch sections only come in pairs of poles, so they round up.
+    int order = juce::jlimit(1, 2 * maxStages, currentSlope / 6);
+    int numStages = (order + 1) / 2;
+    bool oddOrder = (order % 2) != 0 && (type == HIGHPASS || type == LOWPASS);
     currentNumStages = numStages;
 
     float effectiveQ = q + (resonance / 10.0f);
     effectiveQ = juce::jlimit(0.1f, 20.0f, effectiveQ);
 
-    float stageQ = effectiveQ;
+    // High- and low-pass sections take their frequency and Q from the characteristic's
+    // prototype table. The Q control scales every section, and at its 0.707 default the
+    // response is the exact alignment. Band-pass and notch have no prototype: their
+    // sections share one Q, narrowed as they stack so the band keeps its width.
+    const PrototypeSections* prototype = nullptr;
+    if (type == HIGHPASS || type == LOWPASS)
+        prototype = &getPrototypeSections(static_cast<FilterPrototype>(characteristic), order);
+    double qScale = effectiveQ / 0.707f;
+
+    float bandQ = effectiveQ;
     if (characteristic == BUTTERWORTH && numStages > 1)
     {
-        stageQ = effectiveQ * 0.707f / std::sqrt(static_cast<float>(numStages));
+        bandQ = effectiveQ * 0.707f / std::sqrt(static_cast<float>(numStages));
     }
     else if (characteristic == LINKWITZ_RILEY)
     {
-        stageQ = effectiveQ * 0.5f;
+        bandQ = effectiveQ * 0.5f;
     }
     else if (characteristic == BESSEL)
     {
-        stageQ = effectiveQ * 0.577f / std::sqrt(static_cast<float>(numStages));
+        bandQ = effectiveQ * 0.577f / std::sqrt(static_cast<float>(numStages));
+    }
+
+    SectionForm form = SectionForm::general;
+
+    if (currentDesign == DESIGN_BILINEAR)
+    {
+        switch (type)
+        {
+        case HIGHPASS: form = SectionForm::highPass; break;
+        case LOWPASS: form = SectionForm::lowPass; break;
+        case BANDPASS: form = SectionForm::bandPass; break;
+        case NOTCH: form = SectionForm::notch; break;
+        default: form = SectionForm::highPass; break;
+        }
     }
 
-    juce::ScopedLock lock(coefficientLock);
-    currentCoefficients.clear();
+    // Intermediate sweep points take the prewarped gain from the table; once the smoothers
+    // settle the design is computed directly, so the resting response is exact.
+    bool sweeping = rampToNewValues
+        && (smoothedCutoff.isSmoothing() || smoothedQ.isSmoothing() || smoothedResonance.isSmoothing()
+            || smoothedSideCutoff.isSmoothing() || envelopeSweeping || lfoSweeping);
+
+    // Mid/side designs the side cascade alongside the mid one, differing only in cutoff.
+    const int numCascades = usesMidSide(currentChannelMode) ? 2 : 1;
+
+    designStages(cutoff, stageDesigns.data(), stateVariableDesigns.data(), prototype, type, numStages, oddOrder,
+                 qScale, bandQ, sweeping);
+
+    if (numCascades > 1)
+        designStages(sideCutoff, sideStageDesigns.data(), sideStateVariableDesigns.data(), prototype, type, numStages,
+                     oddOrder, qScale, bandQ, sweeping);
+
+    if (currentEngine == ENGINE_STATE_VARIABLE)
+    {
+        auto* sideDesigns = numCascades > 1 ? sideStateVariableDesigns.data() : nullptr;
+
+        if (isUsingDoublePrecision())
+            loadDesign<double>(stateVariableDesigns.data(), sideDesigns, form, numStages, oddOrder, rampToNewValues);
+        else
+            loadDesign<float>(stateVariableDesigns.data(), sideDesigns, form, numStages, oddOrder, rampToNewValues);
+    }
+    else
+    {
+        auto* sideDesigns = numCascades > 1 ? sideStageDesigns.data() : nullptr;
+
+        if (isUsingDoublePrecision())
+            loadDesign<double>(stageDesigns.data(), sideDesigns, form, numStages, oddOrder, rampToNewValues);
+        else
+            loadDesign<float>(stageDesigns.data(), sideDesigns, form, numStages, oddOrder, rampToNewValues);
+    }
+
+    coefficientsChanged = true;
+}
+
+// Designs one cascade's stages at the given cutoff, straight into the preallocated per-stage
+// storage: no allocation and no lock on the audio thread. prototype is null for band-pass
+// and notch, whose sections all take bandQ.
+void DynamicFilterProcessor::designStages(double cutoff, BiquadCoefficients* biquads,
+                                          StateVariableCoefficients* stateVariables,
+                                          const PrototypeSections* prototype, int type, int numStages,
+                                          bool oddOrder, double qScale, double bandQ, bool sweeping) noexcept
+{
+    const auto& prewarpTable = prewarpTables[(size_t)oversamplingIndex];
+    double maxSectionFrequency = 0.49 * processingSampleRate;
+    double gainFrequency = -1.0;
+    double gain = 0.0;
 
     for (int stage = 0; stage < numStages; ++stage)
     {
-        FilterCoefs::Ptr coefs;
+        double frequency = cutoff;
+        double stageQ = bandQ;
 
-        switch (type)
+        if (prototype != nullptr)
         {
-        case HIGHPASS:
-            coefs = FilterCoefs::makeHighPass(currentSampleRate, cutoff, stageQ);
-            break;
-        case LOWPASS:
-            coefs = FilterCoefs::makeLowPass(currentSampleRate, cutoff, stageQ);
-            break;
-        case BANDPASS:
-            coefs = FilterCoefs::makeBandPass(currentSampleRate, cutoff, stageQ);
-            break;
-        case NOTCH:
-            coefs = FilterCoefs::makeNotch(currentSampleRate, cutoff, stageQ);
-            break;
-        default:
-            coefs = FilterCoefs::makeHighPass(currentSampleRate, cutoff, stageQ);
-            break;
+            const auto& section = prototype->sections[(size_t)stage];
+            frequency = type == LOWPASS ? cutoff * section.frequency : cutoff / section.frequency;
+            stageQ = section.q * qScale;
         }
 
-        currentCoefficients.push_back(coefs);
+        // Bessel sections sit above the cutoff, so keep them below Nyquist.
+        frequency = juce::jmin(frequency, maxSectionFrequency);
+        bool firstOrder = oddOrder && stage == numStages - 1;
 
-        if (stage == 0)
+        if (currentDesign == DESIGN_MATCHED)
         {
-            *filterChainL.get<0>().coefficients = *coefs;
-            *filterChainR.get<0>().coefficients = *coefs;
+            auto& design = biquads[stage];
+
+            if (firstOrder)
+            {
+                design = type == LOWPASS
+                    ? BiquadCoefficients::makeMatchedFirstOrderLowPass(processingSampleRate, frequency)
+                    : BiquadCoefficients::makeMatchedFirstOrderHighPass(processingSampleRate, frequency);
+            }
+            else
+            {
+                switch (type)
+                {
+                case LOWPASS:
+                    design = BiquadCoefficients::makeMatchedLowPass(processingSampleRate, frequency, stageQ);
+                    break;
+                case BANDPASS:
+                    design = BiquadCoefficients::makeMatchedBandPass(processingSampleRate, frequency, stageQ);
+                    break;
+                case NOTCH:
+                    design = BiquadCoefficients::makeMatchedNotch(processingSampleRate, frequency, stageQ);
+                    break;
+                case HIGHPASS:
+                default:
+                    design = BiquadCoefficients::makeMatchedHighPass(processingSampleRate, frequency, stageQ);
+                    break;
+                }
+            }
+
+            // Matched numerators have no fixed shape, so both engines run the general kernel.
+            if (currentEngine == ENGINE_STATE_VARIABLE)
+                stateVariables[stage] = StateVariableCoefficients::fromBiquad(design);
+
+            continue;
         }
-        else if (stage == 1)
+
+        // Butterworth and Linkwitz-Riley sections share the cutoff, so one gain serves them all.
+        // Bessel sections scaled past the table's top (0.45 fs) always take the exact tan():
+        // lookup() declines them rather than extrapolating towards the pole.
+        if (frequency != gainFrequency)
         {
-            *filterChainL.get<1>().coefficients = *coefs;
-            *filterChainR.get<1>().coefficients = *coefs;
+            if (!(sweeping && prewarpTable.lookup(frequency, gain)))
+                gain = getPrewarpedGain(processingSampleRate, frequency);
+
+            gainFrequency = frequency;
         }
-        else if (stage == 2)
+
+        if (currentEngine == ENGINE_STATE_VARIABLE)
         {
-            *filterChainL.get<2>().coefficients = *coefs;
-            *filterChainR.get<2>().coefficients = *coefs;
+            // The GUI curve is derived from these once per block, when they are published.
+            auto& design = stateVariables[stage];
+
+            if (firstOrder)
+            {
+                design = type == LOWPASS
+                    ? StateVariableCoefficients::makeFirstOrderLowPassFromGain(gain)
+                    : StateVariableCoefficients::makeFirstOrderHighPassFromGain(gain);
+            }
+            else
+            {
+                switch (type)
+                {
+                case LOWPASS:
+                    design = StateVariableCoefficients::makeLowPassFromGain(gain, stageQ);
+                    break;
+                case BANDPASS:
+                    design = StateVariableCoefficients::makeBandPassFromGain(gain, stageQ);
+                    break;
+                case NOTCH:
+                    design = StateVariableCoefficients::makeNotchFromGain(gain, stageQ);
+                    break;
+                case HIGHPASS:
+                default:
+                    design = StateVariableCoefficients::makeHighPassFromGain(gain, stageQ);
+                    break;
+                }
+            }
         }
-        else if (stage == 3)
+        else
         {
-            *filterChainL.get<3>().coefficients = *coefs;
-            *filterChainR.get<3>().coefficients = *coefs;
+            auto& design = biquads[stage];
+
+            if (firstOrder)
+            {
+                design = type == LOWPASS
+                    ? BiquadCoefficients::makeFirstOrderLowPassFromGain(gain)
+                    : BiquadCoefficients::makeFirstOrderHighPassFromGain(gain);
+            }
+            else
+            {
+                switch (type)
+                {
+                case LOWPASS:
+                    design = BiquadCoefficients::makeLowPassFromGain(gain, stageQ);
+                    break;
+                case BANDPASS:
+                    design = BiquadCoefficients::makeBandPassFromGain(gain, stageQ);
+                    break;
+                case NOTCH:
+                    design = BiquadCoefficients::makeNotchFromGain(gain, stageQ);
+                    break;
+                case HIGHPASS:
+                default:
+                    design = BiquadCoefficients::makeHighPassFromGain(gain, stageQ);
+                    break;
+                }
+            }
         }
     }
+}
+
+template <typename SampleType>
+void DynamicFilterProcessor::loadDesign(const BiquadCoefficients* designs, const BiquadCoefficients* sideDesigns,
+    SectionForm form, int numStages, bool oddOrder, bool rampToNewValues) noexcept
+{
+    auto& cascade = getEngines<SampleType>().biquad;
+    cascade.setIndependentLanes(sideDesigns != nullptr);
 
-    for (int stage = numStages; stage < 4; ++stage)
+    for (int stage = 0; stage < numStages; ++stage)
     {
-        auto bypass = FilterCoefs::makeAllPass(currentSampleRate, 1000.0f);
+        if (sideDesigns != nullptr)
+        {
+            // Mid in lane 0 and side in lane 1, as encoded in processEngines().
+            if (rampToNewValues)
+            {
+                cascade.setTargetCoefficients(stage, 0, designs[stage]);
+                cascade.setTargetCoefficients(stage, 1, sideDesigns[stage]);
+            }
+            else
+            {
+                cascade.setCoefficients(stage, 0, designs[stage]);
+                cascade.setCoefficients(stage, 1, sideDesigns[stage]);
+            }
+        }
+        else if (rampToNewValues)
+        {
+            cascade.setTargetCoefficients(stage, designs[stage]);
+        }
+        else
+        {
+            cascade.setCoefficients(stage, designs[stage]);
+        }
+    }
 
-        if (stage == 0)
+    cascade.setNumStages(numStages);
+    cascade.setSectionForm(form);
+    cascade.setOddOrder(oddOrder);
+}
+
+template <typename SampleType>
+void DynamicFilterProcessor::loadDesign(const StateVariableCoefficients* designs,
+    const StateVariableCoefficients* sideDesigns, SectionForm form, int numStages, bool oddOrder,
+    bool rampToNewValues) noexcept
+{
+    auto& cascade = getEngines<SampleType>().stateVariable;
+
+    for (int stage = 0; stage < numStages; ++stage)
+    {
+        if (sideDesigns != nullptr)
+        {
+            // Mid in lane 0 and side in lane 1, as encoded in processEngines().
+            if (rampToNewValues)
+            {
+                cascade.setTargetCoefficients(stage, 0, designs[stage]);
+                cascade.setTargetCoefficients(stage, 1, sideDesigns[stage]);
+            }
+            else
+            {
+                cascade.setCoefficients(stage, 0, designs[stage]);
+                cascade.setCoefficients(stage, 1, sideDesigns[stage]);
+            }
+        }
+        else if (rampToNewValues)
+        {
+            cascade.setTargetCoefficients(stage, designs[stage]);
+        }
+        else
         {
-            *filterChainL.get<0>().coefficients = *bypass;
-            *filterChainR.get<0>().coefficients = *bypass;
+            cascade.setCoefficients(stage, designs[stage]);
         }
-        else if (stage == 1)
+    }
+
+    cascade.setNumStages(numStages);
+    cascade.setSectionForm(form);
+    cascade.setOddOrder(oddOrder);
+}
+
+void DynamicFilterProcessor::publishResponseSnapshot()
+{
+    if (currentEngine == ENGINE_STATE_VARIABLE)
+    {
+        for (int stage = 0; stage < currentNumStages; ++stage)
+            stageDesigns[(size_t)stage] = stateVariableDesigns[(size_t)stage].toBiquad();
+
+        if (usesMidSide(currentChannelMode))
+            for (int stage = 0; stage < currentNumStages; ++stage)
+                sideStageDesigns[(size_t)stage] = sideStateVariableDesigns[(size_t)stage].toBiquad();
+    }
+
+    responseSnapshot.publish(stageDesigns.data(), currentNumStages, processingSampleRate);
+
+    if (linearPhaseActive)
+        linearPhaseFilter.snapshotChanged();
+
+    updateTailLength();
+    coefficientsChanged = false;
+}
+
+void DynamicFilterProcessor::updateTailLength()
+{
+    // The FIR ends half its length after the latency the host already compensates for.
+    if (linearPhaseActive)
+    {
+        tailLengthSamples = linearPhaseFilter.getTailSamples();
+        tailLengthSeconds.store(static_cast<double>(tailLengthSamples) / currentSampleRate, std::memory_order_relaxed);
+        return;
+    }
+
+    // A section's impulse response decays as r^n for pole radius r. The cascade's response
+    // is the convolution of its sections', so the sum of their decay times bounds it. In
+    // mid/side mode the longer of the two cascades sets the tail.
+    double samples = 0.0;
+    const BiquadCoefficients* cascades[] = { stageDesigns.data(), sideStageDesigns.data() };
+    const int numCascades = usesMidSide(currentChannelMode) ? 2 : 1;
+
+    for (int cascade = 0; cascade < numCascades; ++cascade)
+    {
+        double cascadeSamples = 0.0;
+
+        for (int stage = 0; stage < currentNumStages; ++stage)
         {
-            *filterChainL.get<1>().coefficients = *bypass;
-            *filterChainR.get<1>().coefficients = *bypass;
+            const auto radius = cascades[cascade][stage].getPoleRadius();
+
+            if (radius >= 1.0)
+            {
+                cascadeSamples = maxTailSeconds * processingSampleRate;
+                break;
+            }
+
+            if (radius > 0.0)
+                cascadeSamples += std::log(tailAttenuation) / std::log(radius);
+
+            cascadeSamples += 2.0;   // the section's own two-sample FIR part
         }
-        else if (stage == 2)
+
+        samples = juce::jmax(samples, cascadeSamples);
+    }
+
+    samples = juce::jmin(samples, maxTailSeconds * processingSampleRate);
+
+    // Counted in host-rate samples, like the silence it is compared against.
+    double seconds = samples / processingSampleRate;
+    tailLengthSamples = static_cast<juce::int64>(std::ceil(seconds * currentSampleRate));
+    tailLengthSeconds.store(seconds, std::memory_order_relaxed);
+}
+
+template <typename SampleType>
+void DynamicFilterProcessor::processFilterRun(juce::dsp::AudioBlock<SampleType>& block, int startSample, int numSamples)
+{
+    if (numSamples <= 0)
+        return;
+
+    auto channels = block.getSubBlock(static_cast<size_t>(startSample), static_cast<size_t>(numSamples));
+
+    if (crossfadeRemaining > 0)
+    {
+        auto& outgoing = getEngines<SampleType>(activeSlot ^ 1);
+        auto shadow = juce::dsp::AudioBlock<SampleType>(outgoing.fadeScratch)
+                          .getSubsetChannelBlock(0, channels.getNumChannels())
+                          .getSubBlock(0, channels.getNumSamples());
+
+        shadow.copyFrom(channels);
+        processEngines(outgoing, fadingEngine, fadingChannelMode, shadow);
+        processEngines(getEngines<SampleType>(), currentEngine, currentChannelMode, channels);
+        mixCrossfade(channels, shadow);
+        return;
+    }
+
+    processEngines(getEngines<SampleType>(), currentEngine, currentChannelMode, channels);
+}
+
+// Each set encodes and decodes its own input, so a fade between the two channel modes
+// mixes two plain stereo outputs.
+template <typename SampleType>
+void DynamicFilterProcessor::processEngines(FilterEngines<SampleType>& engines, int engine, int channelMode,
+    const juce::dsp::AudioBlock<SampleType>& block) noexcept
+{
+    if (!usesMidSide(channelMode) || block.getNumChannels() != 2)
+    {
+        engines.process(engine, block);
+        return;
+    }
+
+    auto* left = block.getChannelPointer(0);
+    auto* right = block.getChannelPointer(1);
+    int numSamples = static_cast<int>(block.getNumSamples());
+
+    // Halved on the way in so the decode is a plain sum and difference.
+    for (int i = 0; i < numSamples; ++i)
+    {
+        auto mid = (left[i] + right[i]) * SampleType(0.5);
+        auto side = (left[i] - right[i]) * SampleType(0.5);
+        left[i] = mid;
+        right[i] = side;
+    }
+
+    engines.process(engine, block);
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        auto mid = left[i];
+        auto side = right[i];
+        left[i] = mid + side;
+        right[i] = mid - side;
+    }
+}
+
+// Starts fading from the active set to the other one, which is reset and becomes active.
+// The caller loads the new structure into it right after.
+template <typename SampleType>
+void DynamicFilterProcessor::beginCrossfade(int outgoingEngine)
+{
+    float crossfadeMs = *filterParameters.crossfade;
+    int length = juce::roundToInt(crossfadeMs * 0.001 * processingSampleRate);
+
+    activeSlot ^= 1;
+    getEngines<SampleType>().reset();
+
+    fadingEngine = outgoingEngine;
+    fadingChannelMode = currentChannelMode;
+    crossfadeLength = length;
+    crossfadeRemaining = length;
+}
+
+template <typename SampleType>
+void DynamicFilterProcessor::mixCrossfade(const juce::dsp::AudioBlock<SampleType>& block,
+    const juce::dsp::AudioBlock<SampleType>& outgoing)
+{
+    int numSamples = static_cast<int>(block.getNumSamples());
+    int fadeSamples = juce::jmin(numSamples, crossfadeRemaining);
+    int done = crossfadeLength - crossfadeRemaining;
+    auto step = SampleType(1) / static_cast<SampleType>(crossfadeLength);
+
+    // Linear in amplitude: both sets filter the same input, so their outputs are correlated.
+    for (size_t ch = 0; ch < block.getNumChannels(); ++ch)
+    {
+        auto* incomingData = block.getChannelPointer(ch);
+        auto* outgoingData = outgoing.getChannelPointer(ch);
+
+        for (int i = 0; i < fadeSamples; ++i)
         {
-            *filterChainL.get<2>().coefficients = *bypass;
-            *filterChainR.get<2>().coefficients = *bypass;
+            auto gain = static_cast<SampleType>(done + i + 1) * step;
+            incomingData[i] = outgoingData[i] + (incomingData[i] - outgoingData[i]) * gain;
         }
-        else if (stage == 3)
+    }
+
+    crossfadeRemaining -= fadeSamples;
+}
+
+// One streaming pass over the unfiltered input: accumulates its energy for the meters and
+// keeps the channel average of the first samples for the waveform display, so nothing
+// has to copy the block before it is filtered in place.
+template <typename SampleType>
+void DynamicFilterProcessor::measureInput(const juce::AudioBuffer<SampleType>& input)
+{
+    int numSamples = input.getNumSamples();
+    int numChannels = input.getNumChannels();
+
+    captureLength = visualizerActive.load(std::memory_order_relaxed)
+        ? juce::jmin(numSamples, waveformCaptureLength) : 0;
+
+    std::fill(inputCapture.begin(), inputCapture.begin() + captureLength, 0.0f);
+
+    if (numChannels == 0)
+        return;
+
+    float channelScale = 1.0f / static_cast<float>(numChannels);
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        auto* inputData = input.getReadPointer(ch);
+        int i = 0;
+
+        for (; i < captureLength; ++i)
         {
-            *filterChainL.get<3>().coefficients = *bypass;
-            *filterChainR.get<3>().coefficients = *bypass;
+            float sample = static_cast<float>(inputData[i]);
+            inputLevelSum += sample * sample;
+            inputCapture[(size_t)i] += sample * channelScale;
         }
+
+        for (; i < numSamples; ++i)
+            inputLevelSum += static_cast<float>(inputData[i] * inputData[i]);
     }
 }
 
-void DynamicFilterProcessor::captureWaveforms(const juce::AudioBuffer<float>& input,
-    const juce::AudioBuffer<float>& output)
+template <typename SampleType>
+void DynamicFilterProcessor::captureWaveforms(const juce::AudioBuffer<SampleType>& output)
 {
-    if (!visualizerActive.load(std::memory_order_relaxed))
+    if (captureLength == 0)
         return;
 
     juce::ScopedLock lock(waveformLock);
 
-    int numSamples = juce::jmin(input.getNumSamples(), 128);
-    int numChannels = juce::jmin(input.getNumChannels(), output.getNumChannels());
+    int numChannels = output.getNumChannels();
 
     if (numChannels == 0)
         return;
 
-    for (int i = 0; i < numSamples; ++i)
+    for (int i = 0; i < captureLength; ++i)
     {
-        float inputSample = 0.0f;
         float outputSample = 0.0f;
 
         for (int ch = 0; ch < numChannels; ++ch)
-        {
-            inputSample += input.getSample(ch, i);
-            outputSample += output.getSample(ch, i);
-        }
+            outputSample += static_cast<float>(output.getSample(ch, i));
 
-        inputSample /= static_cast<float>(numChannels);
         outputSample /= static_cast<float>(numChannels);
 
-        inputWaveformData[waveformWritePos] = inputSample;
+        inputWaveformData[waveformWritePos] = inputCapture[(size_t)i];
         outputWaveformData[waveformWritePos] = outputSample;
 
         waveformWritePos = (waveformWritePos + 1) % waveformSize;
     }
 }
 
-void DynamicFilterProcessor::updateMetrics(const juce::AudioBuffer<float>& input,
-    const juce::AudioBuffer<float>& output)
+template <typename SampleType>
+void DynamicFilterProcessor::updateMetrics(const juce::AudioBuffer<SampleType>& output)
 {
-    int numSamples = input.getNumSamples();
-    int numChannels = juce::jmin(input.getNumChannels(), output.getNumChannels());
+    int numSamples = output.getNumSamples();
+    int numChannels = output.getNumChannels();
 
     if (numChannels == 0 || numSamples == 0)
         return;
 
     for (int ch = 0; ch < numChannels; ++ch)
     {
-        auto* inputData = input.getReadPointer(ch);
         auto* outputData = output.getReadPointer(ch);
 
         for (int i = 0; i < numSamples; ++i)
-        {
-            inputLevelSum += inputData[i] * inputData[i];
-            outputLevelSum += outputData[i] * outputData[i];
-        }
+            outputLevelSum += static_cast<float>(outputData[i] * outputData[i]);
     }
 
     levelSampleCount += numSamples * numChannels;
@@ -312,198 +1003,472 @@ void DynamicFilterProcessor::getOutputWaveform(std::vector<float>& waveform)
 
 void DynamicFilterProcessor::getFrequencyResponse(std::vector<float>& magnitudes)
 {
-    juce::ScopedLock lock(coefficientLock);
+    std::array<BiquadCoefficients, CoefficientSnapshot::maxStages> stages;
+    double sampleRate = 0.0;
+    const int numStages = responseSnapshot.read(stages, sampleRate);
 
     magnitudes.clear();
     magnitudes.resize(512, 0.0f);
 
-    if (currentCoefficients.empty())
+    if (numStages == 0)
         return;
 
     for (int i = 0; i < 512; ++i)
     {
-        float freq = 20.0f * std::pow(1000.0f, i / 511.0f);
+        double freq = 20.0 * std::pow(1000.0, i / 511.0);
+        double magnitude = 1.0;
 
-        std::complex<float> totalResponse(1.0f, 0.0f);
+        for (int stage = 0; stage < numStages; ++stage)
+            magnitude *= stages[(size_t)stage].getMagnitudeForFrequency(freq, sampleRate);
 
-        for (auto& coef : currentCoefficients)
-        {
-            auto response = coef->getMagnitudeForFrequency(static_cast<double>(freq), currentSampleRate);
-            totalResponse *= std::complex<float>(static_cast<float>(response), 0.0f);
-        }
-
-        float magnitude = std::abs(totalResponse);
-        magnitudes[i] = 20.0f * std::log10(juce::jmax(0.00001f, magnitude));
+        magnitudes[i] = 20.0f * std::log10(juce::jmax(0.00001f, static_cast<float>(magnitude)));
     }
 }
 
 void DynamicFilterProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer&)
+{
+    processBuses(buffer);
+}
+
+void DynamicFilterProcessor::processBlock(juce::AudioBuffer<double>& buffer, juce::MidiBuffer&)
+{
+    processBuses(buffer);
+}
+
+// A disabled sidechain contributes no channels, so the host buffer is the main bus as it
+// stands. Otherwise both buses are referenced in place; the key is never copied.
+template <typename SampleType>
+void DynamicFilterProcessor::processBuses(juce::AudioBuffer<SampleType>& buffer)
+{
+    int firstKeyChannel = sidechainChannels > 0 ? getChannelIndexInProcessBlockBuffer(true, 1, 0) : 0;
+
+    if (sidechainChannels == 0 || buffer.getNumChannels() < firstKeyChannel + sidechainChannels)
+    {
+        processSamples(buffer, juce::dsp::AudioBlock<SampleType>());
+        return;
+    }
+
+    auto mainBus = getBusBuffer(buffer, false, 0);
+    auto key = juce::dsp::AudioBlock<SampleType>(buffer).getSubsetChannelBlock(
+        static_cast<size_t>(firstKeyChannel), static_cast<size_t>(sidechainChannels));
+
+    processSamples(mainBus, key);
+}
+
+template <typename SampleType>
+void DynamicFilterProcessor::processSamples(juce::AudioBuffer<SampleType>& buffer,
+    const juce::dsp::AudioBlock<SampleType>& key)
 {
     juce::ScopedNoDenormals noDenormals;
 
-    auto totalNumInputChannels = getTotalNumInputChannels();
-    auto totalNumOutputChannels = getTotalNumOutputChannels();
+    auto numInputChannels = getMainBusNumInputChannels();
+    auto numOutputChannels = getMainBusNumOutputChannels();
 
-    for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
+    for (auto i = numInputChannels; i < numOutputChannels; ++i)
         buffer.clear(i, 0, buffer.getNumSamples());
 
     if (buffer.getNumSamples() == 0)
         return;
 
-    juce::AudioBuffer<float> inputCopy;
-    inputCopy.makeCopyOf(buffer);
-
-    bool bypass = *apvts.getRawParameterValue("bypass") > 0.5f;
+    bool bypass = *filterParameters.bypass > 0.5f;
     bypassState = bypass;
 
-    if (!bypass)
+    const bool inputSilent = buffer.getMagnitude(0, buffer.getNumSamples()) < static_cast<SampleType>(silenceThreshold);
+
+    // Idle: silent input and a tail that has already rung out. Nothing below would
+    // change the output, so skip the filters, metering and waveform capture entirely.
+    if (idle)
+    {
+        if (inputSilent)
+        {
+            buffer.clear();
+            return;
+        }
+
+        idle = false;
+        wakingFromIdle = true;
+    }
+
+    silentSamples = inputSilent ? silentSamples + buffer.getNumSamples() : 0;
+
+    measureInput(buffer);
+
+    int newOversampling = juce::jlimit(0, maxOversamplingIndex,
+        static_cast<int>(*filterParameters.oversampling));
+
+    // The rate change invalidates the state and the designs, so this restarts the filters
+    // (and changes the reported latency) rather than crossfading.
+    if (newOversampling != oversamplingIndex)
+    {
+        setOversampling<SampleType>(newOversampling);
+        updateFilterCoefficients(false);
+    }
+
+    // Likewise for the phase mode, whose latency differs by far more. The FIR is allocated,
+    // designed and given its threads on the message thread; the cascades play until then.
+    bool newLinearPhase = *filterParameters.phase > 0.5f;
+
+    if (newLinearPhase != linearPhaseRequested)
+    {
+        linearPhaseRequested = newLinearPhase;
+        triggerAsyncUpdate();
+    }
+
+    if (newLinearPhase != linearPhaseActive && (!newLinearPhase || linearPhaseFilter.isReady()))
+        setLinearPhase<SampleType>(newLinearPhase);
+
+    if (linearPhaseActive)
+        linearPhaseFilter.setNonRealtime(isNonRealtime());
+
+    juce::dsp::AudioBlock<SampleType> hostBlock(buffer);
+    auto* oversampler = linearPhaseActive ? nullptr : getOversampler<SampleType>(oversamplingIndex);
+    int factor = 1 << oversamplingIndex;
+
+    // Still pass through the resampling filters or the FIR's delay so the output keeps the
+    // latency the host is compensating for.
+    if (bypass && linearPhaseActive)
+    {
+        linearPhaseFilter.process(hostBlock, true);
+    }
+    else if (bypass && oversampler != nullptr)
     {
-        float targetCutoff = *apvts.getRawParameterValue("cutoff");
-        float targetQ = *apvts.getRawParameterValue("q");
-        float targetResonance = *apvts.getRawParameterValue("resonance");
-        int newType = static_cast<int>(*apvts.getRawParameterValue("type"));
-        int newSlope = (static_cast<int>(*apvts.getRawParameterValue("slope")) + 1) * 12;
-        int newChar = static_cast<int>(*apvts.getRawParameterValue("characteristic"));
+        oversampler->processSamplesUp(hostBlock);
+        oversampler->processSamplesDown(hostBlock);
+    }
 
-        bool cutoffBypass = *apvts.getRawParameterValue("cutoffBypass") > 0.5f;
-        bool qBypass = *apvts.getRawParameterValue("qBypass") > 0.5f;
-        bool resonanceBypass = *apvts.getRawParameterValue("resonanceBypass") > 0.5f;
+    if (!bypass)
+    {
+        float targetCutoff = *filterParameters.cutoff;
+        float targetQ = *filterParameters.q;
+        float targetResonance = *filterParameters.resonance;
+        int newType = static_cast<int>(*filterParameters.type);
+        int newSlope = getSlopeForChoice(static_cast<int>(*filterParameters.slope));
+        int newChar = static_cast<int>(*filterParameters.characteristic);
+        int newEngine = static_cast<int>(*filterParameters.engine);
+        int newDesign = static_cast<int>(*filterParameters.design);
+        int newChannelMode = static_cast<int>(*filterParameters.channelMode);
+        float targetSideCutoff = *filterParameters.sideCutoff;
+
+        bool cutoffBypass = *filterParameters.cutoffBypass > 0.5f;
+        bool qBypass = *filterParameters.qBypass > 0.5f;
+        bool resonanceBypass = *filterParameters.resonanceBypass > 0.5f;
+
+        int blockSamples = buffer.getNumSamples();
+        int minGlide = static_cast<int>(std::floor(smoothingSeconds * currentSampleRate));
 
         if (!cutoffBypass)
         {
-            smoothedCutoff.setTargetValue(targetCutoff);
+            glideTo(smoothedCutoff, cutoffAutomated, targetCutoff, blockSamples, minGlide);
+            glideTo(smoothedSideCutoff, sideCutoffAutomated, targetSideCutoff, blockSamples, minGlide);
         }
         else
         {
-            smoothedCutoff.setTargetValue(1000.0f);
+            glideTo(smoothedCutoff, cutoffAutomated, 1000.0f, blockSamples, minGlide);
+            glideTo(smoothedSideCutoff, sideCutoffAutomated, 1000.0f, blockSamples, minGlide);
         }
 
         if (!qBypass)
         {
-            smoothedQ.setTargetValue(targetQ);
+            glideTo(smoothedQ, qAutomated, targetQ, blockSamples, minGlide);
         }
         else
         {
-            smoothedQ.setTargetValue(0.707f);
+            glideTo(smoothedQ, qAutomated, 0.707f, blockSamples, minGlide);
         }
 
         if (!resonanceBypass)
         {
-            smoothedResonance.setTargetValue(targetResonance);
+            glideTo(smoothedResonance, resonanceAutomated, targetResonance, blockSamples, minGlide);
         }
         else
         {
-            smoothedResonance.setTargetValue(0.0f);
+            glideTo(smoothedResonance, resonanceAutomated, 0.0f, blockSamples, minGlide);
         }
 
-        bool structuralChange = (newType != previousType) ||
-            (newSlope != previousSlope) ||
-            (newChar != previousCharacteristic);
+        // The state is zero after idling, so there is nothing to glide from: load the
+        // current settings directly.
+        if (wakingFromIdle)
+        {
+            smoothedCutoff.setCurrentAndTargetValue(smoothedCutoff.getTargetValue());
+            smoothedQ.setCurrentAndTargetValue(smoothedQ.getTargetValue());
+            smoothedResonance.setCurrentAndTargetValue(smoothedResonance.getTargetValue());
+            smoothedSideCutoff.setCurrentAndTargetValue(smoothedSideCutoff.getTargetValue());
+        }
+
+        // A change arriving mid-crossfade waits for it to finish, then fades in turn.
+        bool structuralChange = wakingFromIdle ||
+            (crossfadeRemaining == 0 &&
+                ((newType != previousType) ||
+                 (newSlope != previousSlope) ||
+                 (newChar != previousCharacteristic) ||
+                 (newEngine != previousEngine) ||
+                 (newDesign != previousDesign) ||
+                 (newChannelMode != previousChannelMode)));
 
         if (structuralChange)
         {
-            filterChainL.reset();
-            filterChainR.reset();
+            // The linear-phase path fades to each new FIR by itself.
+            if (wakingFromIdle || linearPhaseActive || *filterParameters.crossfade <= 0.0f)
+                getEngines<SampleType>().reset();
+            else
+                beginCrossfade<SampleType>(currentEngine);
 
             previousType = newType;
             previousSlope = newSlope;
             previousCharacteristic = newChar;
+            previousEngine = newEngine;
+            previousDesign = newDesign;
+            previousChannelMode = newChannelMode;
 
             currentType = newType;
             currentSlope = newSlope;
             currentCharacteristic = newChar;
+            currentEngine = newEngine;
+            currentDesign = newDesign;
+            currentChannelMode = newChannelMode;
+
+            if (!cutoffBypass)
+            {
+                currentCutoff = smoothedCutoff.getNextValue();
+                currentSideCutoff = smoothedSideCutoff.getNextValue();
+            }
 
-            if (!cutoffBypass) currentCutoff = smoothedCutoff.getNextValue();
             if (!qBypass) currentQ = smoothedQ.getNextValue();
             if (!resonanceBypass) currentResonance = smoothedResonance.getNextValue();
 
-            updateFilterCoefficients();
+            updateFilterCoefficients(false);
         }
 
+        auto block = oversampler != nullptr ? oversampler->processSamplesUp(hostBlock) : hostBlock;
         int numSamples = buffer.getNumSamples();
-        int numChannels = buffer.getNumChannels();
+        int interval = getUpdateInterval();
+
+        bool envelopeActive = *envelopeParameters.depth != 0.0f;
+        envelopeFollower.setAttackAndRelease(*envelopeParameters.attack, *envelopeParameters.release);
 
-        for (int sample = 0; sample < numSamples; ++sample)
+        int lfoSpacing = renderLfos(numSamples, interval);
+        bool lfoActive = lfoSpacing > 0;
+
+        // Keyed from the sidechain when it is selected and connected, else from the input.
+        bool keyed = *envelopeParameters.source > 0.5f && key.getNumChannels() > 0;
+        auto detectorInput = keyed ? key : hostBlock;
+
+        // Coefficients are recomputed once per control interval and interpolated per sample
+        // in between, so automation costs the same however fast the host moves a knob.
+        // Intervals are counted at the host rate; each covers factor times as many
+        // oversampled samples.
+        for (int start = 0; start < numSamples; start += interval)
         {
+            int length = juce::jmin(interval, numSamples - start);
             bool needsUpdate = false;
 
-            if (!cutoffBypass)
+            if (!cutoffBypass && smoothedCutoff.isSmoothing())
             {
-                float smoothCutoff = smoothedCutoff.getNextValue();
-                if (std::abs(smoothCutoff - currentCutoff) > 0.1f)
-                {
-                    currentCutoff = smoothCutoff;
-                    needsUpdate = true;
-                }
+                currentCutoff = smoothedCutoff.skip(length);
+                needsUpdate = true;
             }
 
-            if (!qBypass)
+            if (!qBypass && smoothedQ.isSmoothing())
             {
-                float smoothQ = smoothedQ.getNextValue();
-                if (std::abs(smoothQ - currentQ) > 0.001f)
-                {
-                    currentQ = smoothQ;
-                    needsUpdate = true;
-                }
+                currentQ = smoothedQ.skip(length);
+                needsUpdate = true;
             }
 
-            if (!resonanceBypass)
+            if (!resonanceBypass && smoothedResonance.isSmoothing())
             {
-                float smoothResonance = smoothedResonance.getNextValue();
-                if (std::abs(smoothResonance - currentResonance) > 0.01f)
-                {
-                    currentResonance = smoothResonance;
-                    needsUpdate = true;
-                }
+                currentResonance = smoothedResonance.skip(length);
+                needsUpdate = true;
             }
 
-            if (needsUpdate)
-                updateFilterCoefficients();
-
-            if (numChannels >= 1)
+            // Smoothed on its own, so a side sweep never drags the mid along or back.
+            if (!cutoffBypass && smoothedSideCutoff.isSmoothing())
             {
-                float inputSample = buffer.getSample(0, sample);
-                juce::AudioBuffer<float> tempBuffer(1, 1);
-                tempBuffer.setSample(0, 0, inputSample);
+                currentSideCutoff = smoothedSideCutoff.skip(length);
+                needsUpdate = true;
+            }
 
-                juce::dsp::AudioBlock<float> block(tempBuffer);
-                juce::dsp::ProcessContextReplacing<float> context(block);
+            // Unkeyed, the host block still holds this interval's unfiltered input:
+            // oversampling filters a copy, and otherwise each run is only filtered below.
+            // Changes under a cent are left for later, so a steady level costs no designs.
+            float envelopeShift = 0.0f;
 
-                for (int stage = 0; stage < currentNumStages; ++stage)
-                {
-                    if (stage == 0) filterChainL.get<0>().process(context);
-                    else if (stage == 1) filterChainL.get<1>().process(context);
-                    else if (stage == 2) filterChainL.get<2>().process(context);
-                    else if (stage == 3) filterChainL.get<3>().process(context);
-                }
+            if (envelopeActive)
+                envelopeShift = getEnvelopeShift(envelopeFollower.process(
+                    detectorInput.getSubBlock(static_cast<size_t>(start), static_cast<size_t>(length))));
 
-                buffer.setSample(0, sample, tempBuffer.getSample(0, 0));
+            bool envelopeMoved = std::abs(envelopeShift - currentEnvelopeShift) >= 1.0f / 1200.0f
+                || (envelopeShift == 0.0f && currentEnvelopeShift != 0.0f);
+
+            if (envelopeMoved)
+                currentEnvelopeShift = envelopeShift;
+
+            // The interval after the shift settles redesigns once more off the fast path.
+            if (envelopeMoved || envelopeSweeping)
+            {
+                envelopeSweeping = envelopeMoved;
+                needsUpdate = true;
             }
 
-            if (numChannels >= 2)
+            // Running LFOs redesign every interval, and once more after the last stops.
+            if (lfoActive || lfoSweeping)
             {
-                float inputSample = buffer.getSample(1, sample);
-                juce::AudioBuffer<float> tempBuffer(1, 1);
-                tempBuffer.setSample(0, 0, inputSample);
+                for (size_t target = 0; target < numLfoTargets; ++target)
+                    currentLfoModulation[target] = lfoActive ? lfoModulation[target][(size_t)(start / lfoSpacing)] : 0.0f;
 
-                juce::dsp::AudioBlock<float> block(tempBuffer);
-                juce::dsp::ProcessContextReplacing<float> context(block);
+                lfoSweeping = lfoActive;
+                needsUpdate = true;
+            }
 
-                for (int stage = 0; stage < currentNumStages; ++stage)
-                {
-                    if (stage == 0) filterChainR.get<0>().process(context);
-                    else if (stage == 1) filterChainR.get<1>().process(context);
-                    else if (stage == 2) filterChainR.get<2>().process(context);
-                    else if (stage == 3) filterChainR.get<3>().process(context);
-                }
+            if (needsUpdate)
+                updateFilterCoefficients(true);
 
-                buffer.setSample(1, sample, tempBuffer.getSample(0, 0));
-            }
+            if (!linearPhaseActive)
+                processFilterRun(block, start * factor, length * factor);
         }
+
+        if (linearPhaseActive)
+            linearPhaseFilter.process(hostBlock, false);
+        else if (oversampler != nullptr)
+            oversampler->processSamplesDown(hostBlock);
+
+        if (coefficientsChanged)
+            publishResponseSnapshot();
+    }
+
+    wakingFromIdle = false;
+
+    captureWaveforms(buffer);
+    updateMetrics(buffer);
+
+    // Offline renders idle only once the tail reported to the host has fully elapsed, so
+    // the rendered length matches getTailLengthSeconds(). Live, the state check usually
+    // ends it sooner; the pole-derived length still caps it should rounding keep the
+    // recursion ticking over just above the threshold.
+    // With oversampling on, the resampling filters hold up to getLatencySamples() of
+    // the signal on top of that.
+    if (inputSilent && silentSamples >= getLatencySamples())
+    {
+        const bool tailElapsed = silentSamples >= tailLengthSamples + getLatencySamples();
+
+        if (bypass || tailElapsed || (!isNonRealtime() && isTailSettled<SampleType>()))
+            enterIdle<SampleType>();
+    }
+}
+
+template <typename SampleType>
+void DynamicFilterProcessor::prepareOversamplers(int numChannels, int samplesPerBlock)
+{
+    floatOversamplers = {};
+    doubleOversamplers = {};
+
+    for (int index = 1; index <= maxOversamplingIndex; ++index)
+    {
+        // Polyphase IIR half-band stages, with a latency of a few samples; rounded to whole
+        // samples so it can be reported exactly. Only the cascades' cost per factor has been
+        // measured (it grows in proportion); these stages' own cost has not.
+        auto oversampler = std::make_unique<juce::dsp::Oversampling<SampleType>>(
+            static_cast<size_t>(numChannels), static_cast<size_t>(index),
+            juce::dsp::Oversampling<SampleType>::filterHalfBandPolyphaseIIR, true, true);
+
+        oversampler->initProcessing(static_cast<size_t>(samplesPerBlock));
+
+        if constexpr (std::is_same_v<SampleType, double>)
+            doubleOversamplers[(size_t)(index - 1)] = std::move(oversampler);
+        else
+            floatOversamplers[(size_t)(index - 1)] = std::move(oversampler);
     }
+}
+
+// Switches the rate the cascades run at. The caller reloads the coefficients afterwards.
+template <typename SampleType>
+void DynamicFilterProcessor::setOversampling(int index)
+{
+    oversamplingIndex = index;
+    processingSampleRate = currentSampleRate * (1 << index);
+
+    for (int slot = 0; slot < 2; ++slot)
+        getEngines<SampleType>(slot).reset();
+
+    crossfadeRemaining = 0;
+
+    if (auto* oversampler = getOversampler<SampleType>(index))
+        oversampler->reset();
+
+    updateLatency<SampleType>();
+}
+
+// Switches between the cascades and the linear-phase FIR. Neither path has run while the
+// other was in use, so both start from silence.
+template <typename SampleType>
+void DynamicFilterProcessor::setLinearPhase(bool shouldBeLinear)
+{
+    linearPhaseActive = shouldBeLinear;
+    linearPhaseFilter.reset();
+
+    for (int slot = 0; slot < 2; ++slot)
+        getEngines<SampleType>(slot).reset();
+
+    crossfadeRemaining = 0;
+
+    if (auto* oversampler = getOversampler<SampleType>(oversamplingIndex))
+        oversampler->reset();
+
+    updateLatency<SampleType>();
+    updateTailLength();
+}
+
+template <typename SampleType>
+void DynamicFilterProcessor::updateLatency()
+{
+    int latency = 0;
+
+    if (linearPhaseActive)
+        latency = linearPhaseFilter.getLatencySamples();
+    else if (auto* oversampler = getOversampler<SampleType>(oversamplingIndex))
+        latency = juce::roundToInt(oversampler->getLatencyInSamples());
+
+    if (latency != getLatencySamples())
+        setLatencySamples(latency);
+}
+
+template <typename SampleType>
+bool DynamicFilterProcessor::isTailSettled() const noexcept
+{
+    // The FIR's tail is exactly known, so the elapsed-tail check alone ends it.
+    if (linearPhaseActive)
+        return false;
+
+    return crossfadeRemaining == 0
+        && getEngines<SampleType>().isSettled(currentEngine, static_cast<SampleType>(silenceThreshold));
+}
+
+template <typename SampleType>
+void DynamicFilterProcessor::enterIdle()
+{
+    idle = true;
+
+    // Zeroing the state also flushes whatever was left in the denormal range.
+    getEngines<SampleType>().reset();
+    crossfadeRemaining = 0;
+
+    if (auto* oversampler = getOversampler<SampleType>(oversamplingIndex))
+        oversampler->reset();
+
+    linearPhaseFilter.reset();
+    envelopeFollower.reset();
+    currentEnvelopeShift = 0.0f;
+    envelopeSweeping = false;
+
+    inputLevel.store(0.0f, std::memory_order_relaxed);
+    outputLevel.store(0.0f, std::memory_order_relaxed);
+    gainReduction.store(0.0f, std::memory_order_relaxed);
+    inputLevelSum = 0.0f;
+    outputLevelSum = 0.0f;
+    levelSampleCount = 0;
 
-    captureWaveforms(inputCopy, buffer);
-    updateMetrics(inputCopy, buffer);
+    juce::ScopedLock lock(waveformLock);
+    std::fill(inputWaveformData.begin(), inputWaveformData.end(), 0.0f);
+    std::fill(outputWaveformData.begin(), outputWaveformData.end(), 0.0f);
 }
 
 bool DynamicFilterProcessor::hasEditor() const { return true; }
@@ -586,6 +1551,18 @@ juce::AudioProcessorValueTreeState::ParameterLayout DynamicFilterProcessor::crea
     slopes.add("24 dB/oct");
     slopes.add("36 dB/oct");
     slopes.add("48 dB/oct");
+    slopes.add("60 dB/oct");
+    slopes.add("72 dB/oct");
+    slopes.add("84 dB/oct");
+    slopes.add("96 dB/oct");
+    slopes.add("6 dB/oct");
+    slopes.add("18 dB/oct");
+    slopes.add("30 dB/oct");
+    slopes.add("42 dB/oct");
+    slopes.add("54 dB/oct");
+    slopes.add("66 dB/oct");
+    slopes.add("78 dB/oct");
+    slopes.add("90 dB/oct");
     layout.add(std::make_unique<juce::AudioParameterChoice>(
         juce::ParameterID("slope", 1), "Slope", slopes, 1));
 
@@ -596,6 +1573,174 @@ juce::AudioProcessorValueTreeState::ParameterLayout DynamicFilterProcessor::crea
     layout.add(std::make_unique<juce::AudioParameterChoice>(
         juce::ParameterID("characteristic", 1), "Characteristic", characteristics, 0));
 
+    juce::StringArray engines;
+    engines.add("Biquad");
+    engines.add("State Variable");
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID("engine", 1), "Engine", engines, 0));
+
+    juce::StringArray updateIntervals;
+    updateIntervals.add("16 Samples");
+    updateIntervals.add("32 Samples");
+    updateIntervals.add("64 Samples");
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID("updateInterval", 1), "Update Interval", updateIntervals, 1));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID("crossfade", 1), "Structure Crossfade",
+        juce::NormalisableRange<float>(0.0f, 100.0f, 0.1f),
+        20.0f,
+        juce::AudioParameterFloatAttributes()
+        .withLabel(" ms")
+        .withStringFromValueFunction([](float value, int) {
+            return juce::String(value, 1) + " ms";
+            })));
+
+    juce::StringArray oversamplingFactors;
+    oversamplingFactors.add("Off");
+    oversamplingFactors.add("2x");
+    oversamplingFactors.add("4x");
+    oversamplingFactors.add("8x");
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID("oversampling", 1), "Oversampling", oversamplingFactors, 0));
+
+    juce::StringArray designs;
+    designs.add("Bilinear");
+    designs.add("Matched");
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID("design", 1), "Design", designs, 0));
+
+    juce::StringArray phaseModes;
+    phaseModes.add("Minimum");
+    phaseModes.add("Linear");
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID("phase", 1), "Phase", phaseModes, 0));
+
+    juce::StringArray channelModes;
+    channelModes.add("Stereo");
+    channelModes.add("Mid/Side");
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID("channelMode", 1), "Channel Mode", channelModes, 0));
+
+    // Cutoff of the side cascade in mid/side mode; "cutoff" then sets the mid.
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID("sideCutoff", 1),
+        "Side Cutoff Frequency",
+        juce::NormalisableRange<float>(20.0f, 20000.0f, 0.1f, 0.3f),
+        1000.0f,
+        juce::AudioParameterFloatAttributes()
+        .withLabel(" Hz")
+        .withStringFromValueFunction([](float value, int) {
+            return juce::String(static_cast<int>(value)) + " Hz";
+            })));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID("envAttack", 1), "Envelope Attack",
+        juce::NormalisableRange<float>(0.1f, 100.0f, 0.1f, 0.5f),
+        10.0f,
+        juce::AudioParameterFloatAttributes()
+        .withLabel(" ms")
+        .withStringFromValueFunction([](float value, int) {
+            return juce::String(value, 1) + " ms";
+            })));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID("envRelease", 1), "Envelope Release",
+        juce::NormalisableRange<float>(5.0f, 2000.0f, 1.0f, 0.4f),
+        150.0f,
+        juce::AudioParameterFloatAttributes()
+        .withLabel(" ms")
+        .withStringFromValueFunction([](float value, int) {
+            return juce::String(static_cast<int>(value)) + " ms";
+            })));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID("envThreshold", 1), "Envelope Threshold",
+        juce::NormalisableRange<float>(-60.0f, -1.0f, 0.1f),
+        -30.0f,
+        juce::AudioParameterFloatAttributes()
+        .withLabel(" dB")
+        .withStringFromValueFunction([](float value, int) {
+            return juce::String(value, 1) + " dB";
+            })));
+
+    // Octaves the cutoff moves at full scale; negative depths close the filter instead.
+    // At 0 the detector does not run.
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID("envDepth", 1), "Envelope Depth",
+        juce::NormalisableRange<float>(-4.0f, 4.0f, 0.01f),
+        0.0f,
+        juce::AudioParameterFloatAttributes()
+        .withLabel(" oct")
+        .withStringFromValueFunction([](float value, int) {
+            return juce::String(value, 2) + " oct";
+            })));
+
+    // What the envelope follower listens to. Without a connected sidechain, "Sidechain"
+    // follows the input like "Input" does.
+    juce::StringArray envelopeSources;
+    envelopeSources.add("Input");
+    envelopeSources.add("Sidechain");
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID("envSource", 1), "Envelope Source", envelopeSources, 0));
+
+    juce::StringArray lfoShapes;
+    lfoShapes.add("Sine");
+    lfoShapes.add("Triangle");
+    lfoShapes.add("Saw");
+    lfoShapes.add("Sample & Hold");
+    lfoShapes.add("Smooth Random");
+
+    juce::StringArray lfoRates;
+    lfoRates.add("1/32");
+    lfoRates.add("1/16T");
+    lfoRates.add("1/16");
+    lfoRates.add("1/8T");
+    lfoRates.add("1/16D");
+    lfoRates.add("1/8");
+    lfoRates.add("1/4T");
+    lfoRates.add("1/8D");
+    lfoRates.add("1/4");
+    lfoRates.add("1/2T");
+    lfoRates.add("1/4D");
+    lfoRates.add("1/2");
+    lfoRates.add("1/1T");
+    lfoRates.add("1/2D");
+    lfoRates.add("1 Bar");
+    lfoRates.add("2 Bars");
+    lfoRates.add("4 Bars");
+
+    juce::StringArray lfoTargets;
+    lfoTargets.add("Cutoff");
+    lfoTargets.add("Q");
+    lfoTargets.add("Resonance");
+
+    // Depth is bipolar; at 0 the LFO does not run.
+    for (int index = 1; index <= numLfos; ++index)
+    {
+        const auto prefix = "lfo" + juce::String(index);
+        const auto name = "LFO " + juce::String(index) + " ";
+
+        layout.add(std::make_unique<juce::AudioParameterChoice>(
+            juce::ParameterID(prefix + "Shape", 1), name + "Shape", lfoShapes, 0));
+
+        layout.add(std::make_unique<juce::AudioParameterChoice>(
+            juce::ParameterID(prefix + "Rate", 1), name + "Rate", lfoRates, 8));
+
+        layout.add(std::make_unique<juce::AudioParameterChoice>(
+            juce::ParameterID(prefix + "Target", 1), name + "Target", lfoTargets, 0));
+
+        layout.add(std::make_unique<juce::AudioParameterFloat>(
+            juce::ParameterID(prefix + "Depth", 1), name + "Depth",
+            juce::NormalisableRange<float>(-1.0f, 1.0f, 0.001f),
+            0.0f,
+            juce::AudioParameterFloatAttributes()
+            .withLabel(" %")
+            .withStringFromValueFunction([](float value, int) {
+                return juce::String(value * 100.0f, 1) + " %";
+                })));
+    }
+
     return layout;
 }
 
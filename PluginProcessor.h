@@ -1,8 +1,17 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "FilterDesign.h"
+#include "PrewarpTable.h"
+#include "PrototypeTables.h"
+#include "BiquadCascade.h"
+#include "StateVariableCascade.h"
+#include "LinearPhaseFilter.h"
+#include "EnvelopeFollower.h"
+#include "TempoSyncedLfo.h"
 
-class DynamicFilterProcessor : public juce::AudioProcessor
+class DynamicFilterProcessor : public juce::AudioProcessor,
+                               private juce::AsyncUpdater
 {
 public:
     DynamicFilterProcessor();
@@ -16,6 +25,8 @@ public:
 #endif
 
     void processBlock(juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock(juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    bool supportsDoublePrecisionProcessing() const override;
 
     juce::AudioProcessorEditor* createEditor() override;
     bool hasEditor() const override;
@@ -49,9 +60,6 @@ public:
     bool isVisualizerActive() const { return visualizerActive.load(std::memory_order_relaxed); }
 
 private:
-    using Filter = juce::dsp::IIR::Filter<float>;
-    using FilterCoefs = juce::dsp::IIR::Coefficients<float>;
-
     enum FilterType {
         HIGHPASS = 0,
         LOWPASS = 1,
@@ -65,31 +73,283 @@ private:
         BESSEL = 2
     };
 
-    juce::dsp::ProcessorChain<Filter, Filter, Filter, Filter> filterChainL;
-    juce::dsp::ProcessorChain<Filter, Filter, Filter, Filter> filterChainR;
+    enum FilterEngine {
+        ENGINE_BIQUAD = 0,
+        ENGINE_STATE_VARIABLE = 1
+    };
+
+    // Bilinear designs are exact at the cutoff but cramp towards Nyquist; matched designs
+    // follow the analog magnitude all the way up at the cost of a few transcendentals per
+    // update (see BiquadCoefficients::makeMatched*).
+    enum DesignMethod {
+        DESIGN_BILINEAR = 0,
+        DESIGN_MATCHED = 1
+    };
+
+    // Mid/side encodes a stereo pair before the cascades and decodes it after, with a
+    // cutoff of its own for the side; other layouts always run as plain channels.
+    enum ChannelMode {
+        CHANNELS_STEREO = 0,
+        CHANNELS_MID_SIDE = 1
+    };
+
+    // Every channel runs as a lane of one kernel. In mid/side mode the mid and side lanes
+    // carry their own coefficients, so the pair still costs the same as plain stereo.
+    template <typename SampleType>
+    struct FilterEngines
+    {
+        BiquadCascade<SampleType> biquad;
+        StateVariableCascade<SampleType> stateVariable;
+
+        // Holds this set's output while it is being faded out, so the set taking over can
+        // filter the block in place.
+        juce::AudioBuffer<SampleType> fadeScratch;
+
+        void prepare(int maximumBlockSize, int maximumChannels)
+        {
+            biquad.prepare(maximumBlockSize, maximumChannels);
+            stateVariable.prepare(maximumBlockSize, maximumChannels);
+            fadeScratch.setSize(maximumChannels, maximumBlockSize);
+        }
+
+        void reset() noexcept
+        {
+            biquad.reset();
+            stateVariable.reset();
+        }
+
+        void process(int engine, const juce::dsp::AudioBlock<SampleType>& block) noexcept
+        {
+            if (engine == ENGINE_STATE_VARIABLE)
+                stateVariable.process(block);
+            else
+                biquad.process(block);
+        }
+
+        bool isSettled(int engine, SampleType threshold) const noexcept
+        {
+            if (engine == ENGINE_STATE_VARIABLE)
+                return stateVariable.isSettled(threshold);
+
+            return biquad.isSettled(threshold);
+        }
+    };
+
+    // Two sets per processing precision. A structural change (type, slope, characteristic,
+    // engine, design method or channel mode) moves to the other set, which starts from silence on the
+    // new structure while the previous set keeps running with its old coefficients and is
+    // crossfaded out, so the change does not click. Both sets only run during that window.
+    //
+    // Only the sets matching isUsingDoublePrecision() are loaded with coefficients and
+    // run; the double sets keep state and coefficients in double throughout, for low
+    // cutoffs at high sample rates.
+    std::array<FilterEngines<float>, 2> floatEngines;
+    std::array<FilterEngines<double>, 2> doubleEngines;
+    int activeSlot{ 0 };
+
+    int fadingEngine{ ENGINE_BIQUAD };
+    int fadingChannelMode{ CHANNELS_STEREO };
+    int crossfadeLength{ 0 };
+    int crossfadeRemaining{ 0 };
+
+    template <typename SampleType>
+    FilterEngines<SampleType>& getEngines(int slot) noexcept
+    {
+        if constexpr (std::is_same_v<SampleType, double>)
+            return doubleEngines[(size_t)slot];
+        else
+            return floatEngines[(size_t)slot];
+    }
+
+    template <typename SampleType>
+    const FilterEngines<SampleType>& getEngines(int slot) const noexcept
+    {
+        if constexpr (std::is_same_v<SampleType, double>)
+            return doubleEngines[(size_t)slot];
+        else
+            return floatEngines[(size_t)slot];
+    }
+
+    template <typename SampleType>
+    FilterEngines<SampleType>& getEngines() noexcept { return getEngines<SampleType>(activeSlot); }
+
+    template <typename SampleType>
+    const FilterEngines<SampleType>& getEngines() const noexcept { return getEngines<SampleType>(activeSlot); }
+
+    // Upper bound on a supported bus, enough for 7th-order ambisonics or a 9.1.6 bed.
+    static constexpr int maxChannels = 64;
+
+    // With a sidechain connected the main bus is referenced through getBusBuffer(), which
+    // only avoids allocating below 32 channels.
+    static constexpr int maxChannelsWithSidechain = 31;
+
+    // Channels of the sidechain bus (the key), 0 while it is disabled; set in prepareToPlay.
+    int sidechainChannels{ 0 };
+
+    // Input below this (about -160 dBFS) counts as silence, and the filters count as
+    // rung out once all their state has decayed below it.
+    static constexpr float silenceThreshold = 1.0e-8f;
+
+    bool idle{ false };
+    bool wakingFromIdle{ false };
+    juce::int64 silentSamples{ 0 };
+
+    // Tail reported to the host: the time for the current cascade's impulse response to
+    // fall by tailAttenuation (-120 dB), derived from its pole radii whenever the
+    // coefficients change.
+    static constexpr double tailAttenuation = 1.0e-6;
+    static constexpr double maxTailSeconds = 60.0;
+
+    std::atomic<double> tailLengthSeconds{ 0.1 };
+    juce::int64 tailLengthSamples{ 0 };
 
     juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
 
+    // Resolved once in the constructor, so the audio thread never searches the parameter
+    // map; the envelope and LFO parameters are cached alongside their state below.
+    struct FilterParameters
+    {
+        std::atomic<float>* bypass{ nullptr };
+        std::atomic<float>* cutoff{ nullptr };
+        std::atomic<float>* q{ nullptr };
+        std::atomic<float>* resonance{ nullptr };
+        std::atomic<float>* type{ nullptr };
+        std::atomic<float>* slope{ nullptr };
+        std::atomic<float>* characteristic{ nullptr };
+        std::atomic<float>* engine{ nullptr };
+        std::atomic<float>* design{ nullptr };
+        std::atomic<float>* channelMode{ nullptr };
+        std::atomic<float>* sideCutoff{ nullptr };
+        std::atomic<float>* cutoffBypass{ nullptr };
+        std::atomic<float>* qBypass{ nullptr };
+        std::atomic<float>* resonanceBypass{ nullptr };
+        std::atomic<float>* crossfade{ nullptr };
+        std::atomic<float>* oversampling{ nullptr };
+        std::atomic<float>* phase{ nullptr };
+        std::atomic<float>* updateInterval{ nullptr };
+    };
+
+    FilterParameters filterParameters;
+
     bool bypassState{ false };
 
+    // The glide for a one-off change. Values automated continuously glide across each
+    // block instead; see glideTo().
+    static constexpr double smoothingSeconds = 0.02;
+
     juce::LinearSmoothedValue<float> smoothedCutoff;
     juce::LinearSmoothedValue<float> smoothedQ;
     juce::LinearSmoothedValue<float> smoothedResonance;
+    juce::LinearSmoothedValue<float> smoothedSideCutoff;
+
+    // Whether each target moved in the last block.
+    bool cutoffAutomated{ false };
+    bool qAutomated{ false };
+    bool resonanceAutomated{ false };
+    bool sideCutoffAutomated{ false };
 
     float currentCutoff{ 1000.0f };
+    float currentSideCutoff{ 1000.0f };
     float currentQ{ 0.707f };
     float currentResonance{ 0.0f };
     int currentType{ HIGHPASS };
     int currentSlope{ 24 };
     int currentCharacteristic{ BUTTERWORTH };
+    int currentEngine{ ENGINE_BIQUAD };
+    int currentDesign{ DESIGN_BILINEAR };
+    int currentChannelMode{ CHANNELS_STEREO };
     int currentNumStages{ 2 };
 
     int previousType{ HIGHPASS };
     int previousSlope{ 24 };
     int previousCharacteristic{ BUTTERWORTH };
+    int previousEngine{ ENGINE_BIQUAD };
+    int previousDesign{ DESIGN_BILINEAR };
+    int previousChannelMode{ CHANNELS_STEREO };
+
+    // Cutoff modulation from the input level, in octaves, applied on top of both cutoffs.
+    // The detector runs once per control interval; the designs it drives take the prewarp
+    // table's fast path while the shift keeps moving, and one exact design once it stops.
+    EnvelopeFollower envelopeFollower;
+    float currentEnvelopeShift{ 0.0f };
+    bool envelopeSweeping{ false };
+
+    // Looked up once: the detector reads some of these every control interval.
+    struct EnvelopeParameters
+    {
+        std::atomic<float>* attack{ nullptr };
+        std::atomic<float>* release{ nullptr };
+        std::atomic<float>* threshold{ nullptr };
+        std::atomic<float>* depth{ nullptr };
+        std::atomic<float>* source{ nullptr };
+    };
+
+    EnvelopeParameters envelopeParameters;
+
+    // LFO modulation on top of the smoothed values: octaves of cutoff and of Q, and dB of
+    // resonance. renderLfos() fills one value per control interval for the whole block;
+    // while any LFO has depth, every interval redesigns on the fast path, so the cost per
+    // block is fixed whatever the rates and depths.
+    enum LfoTarget {
+        LFO_CUTOFF = 0,
+        LFO_Q = 1,
+        LFO_RESONANCE = 2
+    };
+
+    static constexpr int numLfos = 2;
+    static constexpr int numLfoTargets = 3;
+
+    std::array<TempoSyncedLfo, numLfos> lfos{ { TempoSyncedLfo(0x6c8e9cf5u), TempoSyncedLfo(0x2545f491u) } };
+    std::array<std::vector<float>, numLfoTargets> lfoModulation;
+    std::vector<float> lfoOffsets;
+    std::vector<float> lfoValues;
+    std::array<float, numLfoTargets> currentLfoModulation{};
+    bool lfoSweeping{ false };
+
+    // Looked up once, so the audio thread never builds the numbered IDs.
+    struct LfoParameters
+    {
+        std::atomic<float>* shape{ nullptr };
+        std::atomic<float>* rate{ nullptr };
+        std::atomic<float>* target{ nullptr };
+        std::atomic<float>* depth{ nullptr };
+    };
+
+    std::array<LfoParameters, numLfos> lfoParameters;
 
     double currentSampleRate{ 44100.0 };
 
+    // Rate the cascades run at: the host rate times the oversampling factor. Designs,
+    // the GUI curve and the tail are all computed at this rate.
+    double processingSampleRate{ 44100.0 };
+
+    // Index of the "oversampling" choice: 0 is off, 1..3 are 2x, 4x and 8x. Every factor
+    // is built in prepareToPlay (for the precision in use) so switching never allocates.
+    static constexpr int maxOversamplingIndex = 3;
+
+    std::array<std::unique_ptr<juce::dsp::Oversampling<float>>, maxOversamplingIndex> floatOversamplers;
+    std::array<std::unique_ptr<juce::dsp::Oversampling<double>>, maxOversamplingIndex> doubleOversamplers;
+    int oversamplingIndex{ 0 };
+
+    template <typename SampleType>
+    juce::dsp::Oversampling<SampleType>* getOversampler(int index) noexcept
+    {
+        if (index <= 0)
+            return nullptr;
+
+        if constexpr (std::is_same_v<SampleType, double>)
+            return doubleOversamplers[(size_t)(index - 1)].get();
+        else
+            return floatOversamplers[(size_t)(index - 1)].get();
+    }
+
+    // Linear phase replaces the cascades (and the oversampling around them) with an FIR of
+    // the same magnitude, redesigned in the background from the published snapshot; the
+    // cascades keep receiving coefficients so that snapshot stays current. The FIR has one
+    // kernel for every channel, so in mid/side mode it applies the mid cascade to both.
+    bool linearPhaseActive{ false };
+    bool linearPhaseRequested{ false };   // last mode handed to handleAsyncUpdate()
+
     std::atomic<float> inputLevel{ 0.0f };
     std::atomic<float> outputLevel{ 0.0f };
     std::atomic<float> gainReduction{ 0.0f };
@@ -103,17 +363,85 @@ private:
     static constexpr int levelUpdateInterval = 2048;
 
     static constexpr int waveformSize = 512;
+    static constexpr int waveformCaptureLength = 128;
     std::vector<float> inputWaveformData;
     std::vector<float> outputWaveformData;
     juce::CriticalSection waveformLock;
     int waveformWritePos{ 0 };
 
-    void updateFilterCoefficients();
-    void updateMetrics(const juce::AudioBuffer<float>& input, const juce::AudioBuffer<float>& output);
-    void captureWaveforms(const juce::AudioBuffer<float>& input, const juce::AudioBuffer<float>& output);
+    // Channel-averaged head of the current block's input, taken before it is filtered.
+    std::vector<float> inputCapture;
+    int captureLength{ 0 };
+
+    void updateFilterCoefficients(bool rampToNewValues);
+    int getUpdateInterval() const;
+    void publishResponseSnapshot();
+    void handleAsyncUpdate() override;
+    void updateTailLength();
+    static int getSlopeForChoice(int index) noexcept;
+    float getEnvelopeShift(float envelope) const noexcept;
+    static double getLfoBeatsPerCycle(int index) noexcept;
+    static void glideTo(juce::LinearSmoothedValue<float>& smoother, bool& automated, float target,
+                        int blockSamples, int minSteps) noexcept;
+    int renderLfos(int numSamples, int interval) noexcept;
+    bool usesMidSide(int channelMode) const noexcept;
+    void designStages(double cutoff, BiquadCoefficients* biquads, StateVariableCoefficients* stateVariables,
+                      const PrototypeSections* prototype, int type, int numStages, bool oddOrder, double qScale,
+                      double bandQ, bool sweeping) noexcept;
+
+    // sideDesigns is null unless the side lane runs its own cascade.
+    template <typename SampleType>
+    void loadDesign(const BiquadCoefficients* designs, const BiquadCoefficients* sideDesigns, SectionForm form,
+                    int numStages, bool oddOrder, bool rampToNewValues) noexcept;
+    template <typename SampleType>
+    void loadDesign(const StateVariableCoefficients* designs, const StateVariableCoefficients* sideDesigns,
+                    SectionForm form, int numStages, bool oddOrder, bool rampToNewValues) noexcept;
+
+    template <typename SampleType>
+    void processBuses(juce::AudioBuffer<SampleType>& buffer);
+    template <typename SampleType>
+    void processSamples(juce::AudioBuffer<SampleType>& buffer, const juce::dsp::AudioBlock<SampleType>& key);
+    template <typename SampleType>
+    bool isTailSettled() const noexcept;
+    template <typename SampleType>
+    void enterIdle();
+    template <typename SampleType>
+    void prepareOversamplers(int numChannels, int samplesPerBlock);
+    template <typename SampleType>
+    void setOversampling(int index);
+    template <typename SampleType>
+    void setLinearPhase(bool shouldBeLinear);
+    template <typename SampleType>
+    void updateLatency();
+    template <typename SampleType>
+    void beginCrossfade(int outgoingEngine);
+    template <typename SampleType>
+    void mixCrossfade(const juce::dsp::AudioBlock<SampleType>& block, const juce::dsp::AudioBlock<SampleType>& outgoing);
+    template <typename SampleType>
+    void processFilterRun(juce::dsp::AudioBlock<SampleType>& block, int startSample, int numSamples);
+    template <typename SampleType>
+    void processEngines(FilterEngines<SampleType>& engines, int engine, int channelMode,
+                        const juce::dsp::AudioBlock<SampleType>& block) noexcept;
+    template <typename SampleType>
+    void measureInput(const juce::AudioBuffer<SampleType>& input);
+    template <typename SampleType>
+    void updateMetrics(const juce::AudioBuffer<SampleType>& output);
+    template <typename SampleType>
+    void captureWaveforms(const juce::AudioBuffer<SampleType>& output);
+
+    static constexpr int maxStages = CoefficientSnapshot::maxStages;
+
+    // The mid (or only) cascade, which the GUI curve and the linear-phase FIR follow.
+    std::array<BiquadCoefficients, maxStages> stageDesigns;
+    std::array<StateVariableCoefficients, maxStages> stateVariableDesigns;
+
+    std::array<BiquadCoefficients, maxStages> sideStageDesigns;
+    std::array<StateVariableCoefficients, maxStages> sideStateVariableDesigns;
+    bool coefficientsChanged{ false };
 
-    juce::CriticalSection coefficientLock;
-    std::vector<FilterCoefs::Ptr> currentCoefficients;
+    CoefficientSnapshot responseSnapshot;
+    LinearPhaseFilter linearPhaseFilter{ responseSnapshot };
+    std::array<PrewarpTable, maxOversamplingIndex + 1> prewarpTables;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DynamicFilterProcessor)
 };
\ No newline at end of file
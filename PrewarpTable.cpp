@@ -0,0 +1,80 @@
+#include "PrewarpTable.h"
+#include "FilterDesign.h"
+
+void PrewarpTable::build(double newSampleRate)
+{
+    gains.clear();
+    slopes.clear();
+
+    maxFrequency = maxRelativeFrequency * newSampleRate;
+
+    // Grid points past the top are clamped just below Nyquist, where tan() has its pole.
+    const auto clampFrequency = 0.4999 * newSampleRate;
+    const auto slopeScale = juce::MathConstants<double>::pi / newSampleRate;
+
+    for (size_t index = 0; ; ++index)
+    {
+        const auto frequency = getGridFrequency(index);
+        const auto gain = getPrewarpedGain(newSampleRate, juce::jmin(frequency, clampFrequency));
+
+        gains.push_back(gain);
+        slopes.push_back((1.0 + gain * gain) * slopeScale);
+
+        if (frequency >= maxFrequency)
+            break;
+    }
+
+    // The interpolation error follows tan()'s fourth derivative, which climbs steeply towards
+    // the pole. Check each cell at its centre, where the Hermite error peaks, and end the
+    // table at the first one that misses, so lookup() hands anything above to the exact tan().
+    for (size_t index = 0; index + 1 < gains.size(); ++index)
+    {
+        const auto start = getGridFrequency(index);
+        const auto centre = 0.5 * (start + getGridFrequency(index + 1));
+        double gain = 0.0;
+
+        if (centre >= maxFrequency)
+            break;
+
+        if (!lookup(centre, gain)
+            || std::abs(gain / getPrewarpedGain(newSampleRate, centre) - 1.0) > maxRelativeError)
+        {
+            maxFrequency = start;
+            break;
+        }
+    }
+}
+
+double PrewarpTable::getGridFrequency(size_t index) noexcept
+{
+    const auto octave = static_cast<int>(index / pointsPerOctave);
+    const auto step = static_cast<int>(index % pointsPerOctave);
+    return std::ldexp(minFrequency, octave) * (1.0 + step / static_cast<double>(pointsPerOctave));
+}
+
+bool PrewarpTable::lookup(double frequency, double& gain) const noexcept
+{
+    if (frequency < minFrequency || frequency >= maxFrequency)
+        return false;
+
+    int exponent = 0;
+    const auto mantissa = std::frexp(frequency, &exponent);   // in [0.5, 1)
+    const auto position = (mantissa * 2.0 - 1.0) * pointsPerOctave;
+    const auto step = static_cast<int>(position);
+    const auto index = static_cast<size_t>((exponent - minExponent) * pointsPerOctave + step);
+
+    if (index + 1 >= gains.size())
+        return false;
+
+    const auto t = position - step;
+    const auto t2 = t * t;
+    const auto t3 = t2 * t;
+    const auto spacing = std::ldexp(1.0, exponent - 1) / pointsPerOctave;
+
+    gain = (2.0 * t3 - 3.0 * t2 + 1.0) * gains[index]
+         + (t3 - 2.0 * t2 + t) * slopes[index] * spacing
+         + (3.0 * t2 - 2.0 * t3) * gains[index + 1]
+         + (t3 - t2) * slopes[index + 1] * spacing;
+
+    return true;
+}
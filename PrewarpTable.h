@@ -0,0 +1,46 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Prewarped gain tan(pi * f / fs) tabulated for one sample rate, so coefficient updates
+// during sweeps cost a cubic Hermite interpolation instead of a trig call.
+//
+// The grid is linear inside each octave, which lets lookup() find its cell from the
+// floating-point exponent and mantissa rather than a log(). The Q axis is not tabulated:
+// every section design is a rational function of this gain and 1/Q, so a Q grid would only
+// add memory and interpolation error (a 2-D coefficient table at 16 x 6 points per octave
+// measured 0.5 dB worst case for about 1 MB per rate). The characteristic only moves each
+// section's Q and frequency, so the one table serves every FilterType and FilterCharacteristic.
+//
+// Size: 32 points per octave from 8 Hz to 0.45 fs, two doubles per point
+// (about 5.8 KB at 44.1 kHz and 48 kHz, 6.3 KB at 96 kHz, 6.8 KB at 192 kHz).
+// Accuracy: the gain is within 1.5e-4 of tan() everywhere lookup() answers, at every rate.
+// Higher frequencies (Bessel sections, or a modulated cutoff near the top) are declined
+// and designed directly.
+class PrewarpTable
+{
+public:
+    // Allocates; call from prepareToPlay.
+    void build(double newSampleRate);
+
+    // Returns false when the frequency lies outside the grid; the caller then designs directly.
+    bool lookup(double frequency, double& gain) const noexcept;
+
+    size_t getMemorySize() const noexcept { return (gains.size() + slopes.size()) * sizeof(double); }
+
+private:
+    static constexpr double minFrequency = 8.0;
+    static constexpr int minExponent = 4;   // std::frexp(8.0) == 0.5 * 2^4
+    static constexpr int pointsPerOctave = 32;
+
+    // Above about 0.45 fs the cells are too coarse for the pole: at 0.49 fs the Hermite
+    // overshoots to negative gains and the designs go unstable.
+    static constexpr double maxRelativeFrequency = 0.45;
+    static constexpr double maxRelativeError = 2.0e-4;
+
+    static double getGridFrequency(size_t index) noexcept;
+
+    std::vector<double> gains;
+    std::vector<double> slopes;   // d gain / d frequency, for the Hermite tangents
+    double maxFrequency{ 0.0 };
+};
@@ -0,0 +1,291 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "FilterDesign.h"
+
+// Per-section frequency and Q of the analog low-pass prototypes, for every order the
+// cascades support. Each table is evaluated by the compiler, so a coefficient update
+// only reads it.
+//
+// Frequencies are relative to the cutoff. High-pass designs use the reciprocal. For odd
+// orders the last section is the first-order one: its frequency is the real pole and its
+// Q is unused. Second-order sections are sorted by rising Q, so the resonant ones come
+// last and see a signal that the earlier stages have already band-limited.
+//
+// - Butterworth: -3 dB at the cutoff, every pole on the unit circle.
+// - Linkwitz-Riley: two Butterworth filters of half the order in series, -6 dB at the
+//   cutoff. Only even orders have an alignment, so odd orders fall back to Butterworth.
+// - Bessel: the poles of the reverse Bessel polynomial, scaled for -3 dB at the cutoff.
+// Same order as the "characteristic" parameter's choices.
+enum class FilterPrototype
+{
+    butterworth,
+    linkwitzRiley,
+    bessel
+};
+
+struct PrototypeSection
+{
+    double frequency{ 1.0 };
+    double q{ 0.0 };
+};
+
+struct PrototypeSections
+{
+    int numSections{ 0 };
+    std::array<PrototypeSection, CoefficientSnapshot::maxStages> sections{};
+};
+
+namespace PrototypeDetail
+{
+    constexpr int maxOrder = 2 * CoefficientSnapshot::maxStages;
+    constexpr double pi = 3.14159265358979323846;
+
+    struct Complex
+    {
+        double re{ 0.0 };
+        double im{ 0.0 };
+
+        constexpr Complex operator+ (Complex o) const noexcept { return { re + o.re, im + o.im }; }
+        constexpr Complex operator- (Complex o) const noexcept { return { re - o.re, im - o.im }; }
+        constexpr Complex operator* (Complex o) const noexcept { return { re * o.re - im * o.im, re * o.im + im * o.re }; }
+
+        constexpr Complex operator/ (Complex o) const noexcept
+        {
+            const auto norm = o.re * o.re + o.im * o.im;
+            return { (re * o.re + im * o.im) / norm, (im * o.re - re * o.im) / norm };
+        }
+
+        constexpr double normSquared() const noexcept { return re * re + im * im; }
+    };
+
+    constexpr double squareRoot(double x) noexcept
+    {
+        if (x <= 0.0)
+            return 0.0;
+
+        auto y = x > 1.0 ? x : 1.0;
+
+        for (int i = 0; i < 64; ++i)
+        {
+            const auto next = 0.5 * (y + x / y);
+
+            if (next == y)
+                break;
+
+            y = next;
+        }
+
+        return y;
+    }
+
+    // Taylor series, accurate to double precision for |x| <= pi / 2.
+    constexpr double sine(double x) noexcept
+    {
+        auto term = x;
+        auto sum = x;
+
+        for (int n = 1; n < 12; ++n)
+        {
+            term *= -x * x / static_cast<double>((2 * n) * (2 * n + 1));
+            sum += term;
+        }
+
+        return sum;
+    }
+
+    constexpr PrototypeSection sectionFromPole(Complex pole) noexcept
+    {
+        const auto radius = squareRoot(pole.normSquared());
+        return { radius, radius / (-2.0 * pole.re) };
+    }
+
+    constexpr void sortByQ(PrototypeSections& table, int numSecondOrder) noexcept
+    {
+        for (int i = 1; i < numSecondOrder; ++i)
+            for (int j = i; j > 0 && table.sections[(size_t)j].q < table.sections[(size_t)(j - 1)].q; --j)
+            {
+                const auto swapped = table.sections[(size_t)j];
+                table.sections[(size_t)j] = table.sections[(size_t)(j - 1)];
+                table.sections[(size_t)(j - 1)] = swapped;
+            }
+    }
+
+    constexpr PrototypeSections makeButterworth(int order) noexcept
+    {
+        // Pole pair k sits at angle (2k - 1) pi / 2N from the imaginary axis, so its section
+        // has Q = 1 / (2 sin angle).
+        PrototypeSections table;
+        table.numSections = (order + 1) / 2;
+
+        for (int k = 1; k <= order / 2; ++k)
+            table.sections[(size_t)(k - 1)] = { 1.0, 0.5 / sine((2 * k - 1) * pi / (2.0 * order)) };
+
+        if (order % 2 != 0)
+            table.sections[(size_t)(order / 2)] = { 1.0, 0.0 };
+
+        sortByQ(table, order / 2);
+        return table;
+    }
+
+    constexpr PrototypeSections makeLinkwitzRiley(int order) noexcept
+    {
+        if (order % 2 != 0)
+            return makeButterworth(order);
+
+        // Each Butterworth pair appears twice; the two real poles of an odd half-order
+        // merge into one critically damped section.
+        const auto half = makeButterworth(order / 2);
+        const auto halfPairs = order / 4;
+
+        PrototypeSections table;
+        table.numSections = order / 2;
+
+        for (int k = 0; k < halfPairs; ++k)
+            table.sections[(size_t)(2 * k)] = table.sections[(size_t)(2 * k + 1)] = half.sections[(size_t)k];
+
+        if ((order / 2) % 2 != 0)
+            table.sections[(size_t)(2 * halfPairs)] = { 1.0, 0.5 };
+
+        sortByQ(table, table.numSections);
+        return table;
+    }
+
+    // theta_N(s) = sum a_k s^k with a_k = (2N - k)! / (2^(N - k) k! (N - k)!), built from
+    // a_N = 1 downwards with the ratio a_(k-1) / a_k = (2N - k + 1)(k) / (2 (N - k + 1)).
+    constexpr std::array<double, maxOrder + 1> makeReverseBessel(int order) noexcept
+    {
+        std::array<double, maxOrder + 1> a{};
+        a[(size_t)order] = 1.0;
+
+        for (int k = order; k > 0; --k)
+            a[(size_t)(k - 1)] = a[(size_t)k] * static_cast<double>((2 * order - k + 1) * k)
+                                 / static_cast<double>(2 * (order - k + 1));
+
+        return a;
+    }
+
+    constexpr Complex evaluate(const std::array<double, maxOrder + 1>& a, int order, Complex s) noexcept
+    {
+        Complex result{ a[(size_t)order], 0.0 };
+
+        for (int k = order - 1; k >= 0; --k)
+            result = result * s + Complex{ a[(size_t)k], 0.0 };
+
+        return result;
+    }
+
+    // Newton step p(s) / p'(s), with both from one Horner pass.
+    constexpr Complex newtonStep(const std::array<double, maxOrder + 1>& a, int order, Complex s) noexcept
+    {
+        Complex value{ a[(size_t)order], 0.0 };
+        Complex derivative;
+
+        for (int k = order - 1; k >= 0; --k)
+        {
+            derivative = derivative * s + value;
+            value = value * s + Complex{ a[(size_t)k], 0.0 };
+        }
+
+        return value / derivative;
+    }
+
+    constexpr PrototypeSections makeBessel(int order) noexcept
+    {
+        const auto a = makeReverseBessel(order);
+
+        // Aberth iteration, started on a left-half-plane arc that spans the roots: cubic
+        // convergence, and the roots repel each other so none is found twice.
+        std::array<Complex, maxOrder> roots{};
+        const auto radius = static_cast<double>(order);
+
+        for (int k = 0; k < order; ++k)
+        {
+            const auto angle = pi * (0.5 + (k + 0.5) / order);
+            const auto offset = angle - pi;   // |offset| <= pi / 2
+            roots[(size_t)k] = { -radius * sine(0.5 * pi - (offset < 0.0 ? -offset : offset)),
+                                 radius * sine(offset) };
+        }
+
+        for (int iteration = 0; iteration < 32; ++iteration)
+        {
+            double largestStep = 0.0;
+
+            for (int i = 0; i < order; ++i)
+            {
+                const auto z = roots[(size_t)i];
+                const auto ratio = newtonStep(a, order, z);
+
+                Complex repulsion;
+                for (int j = 0; j < order; ++j)
+                    if (j != i)
+                        repulsion = repulsion + Complex{ 1.0, 0.0 } / (z - roots[(size_t)j]);
+
+                const auto step = ratio / (Complex{ 1.0, 0.0 } - ratio * repulsion);
+                roots[(size_t)i] = z - step;
+
+                const auto size = step.normSquared() / (z.normSquared() + 1.0);
+                largestStep = size > largestStep ? size : largestStep;
+            }
+
+            // Relative steps of 1e-8: past this the high orders only wander in rounding noise.
+            if (largestStep < 1.0e-16)
+                break;
+        }
+
+        // |H(jw)|^2 = a0^2 / |theta(jw)|^2 falls monotonically; find where it reaches 1/2.
+        double low = 0.0;
+        double high = 2.0 * radius;
+
+        for (int i = 0; i < 60; ++i)
+        {
+            const auto mid = 0.5 * (low + high);
+            const auto gainSquared = a[0] * a[0] / evaluate(a, order, { 0.0, mid }).normSquared();
+
+            if (gainSquared > 0.5)
+                low = mid;
+            else
+                high = mid;
+        }
+
+        const auto scale = 1.0 / (0.5 * (low + high));
+
+        PrototypeSections table;
+        table.numSections = (order + 1) / 2;
+        int pairs = 0;
+
+        for (int k = 0; k < order; ++k)
+        {
+            const Complex pole{ roots[(size_t)k].re * scale, roots[(size_t)k].im * scale };
+
+            if (pole.im > 1.0e-9)
+                table.sections[(size_t)pairs++] = sectionFromPole(pole);
+            else if (pole.im > -1.0e-9)
+                table.sections[(size_t)(order / 2)] = { -pole.re, 0.0 };
+        }
+
+        sortByQ(table, order / 2);
+        return table;
+    }
+
+    // One constant per table, so each is a separate (and small) compile-time evaluation.
+    template <int Order> inline constexpr PrototypeSections butterworth = makeButterworth(Order);
+    template <int Order> inline constexpr PrototypeSections linkwitzRiley = makeLinkwitzRiley(Order);
+    template <int Order> inline constexpr PrototypeSections bessel = makeBessel(Order);
+
+    template <size_t... Index>
+    constexpr std::array<std::array<PrototypeSections, maxOrder>, 3> collect(std::index_sequence<Index...>) noexcept
+    {
+        return { { { butterworth<static_cast<int>(Index) + 1>... },
+                   { linkwitzRiley<static_cast<int>(Index) + 1>... },
+                   { bessel<static_cast<int>(Index) + 1>... } } };
+    }
+
+    inline constexpr auto tables = collect(std::make_index_sequence<maxOrder>());
+}
+
+inline const PrototypeSections& getPrototypeSections(FilterPrototype prototype, int order) noexcept
+{
+    const auto index = juce::jlimit(1, PrototypeDetail::maxOrder, order) - 1;
+    return PrototypeDetail::tables[(size_t)prototype][(size_t)index];
+}
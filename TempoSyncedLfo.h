@@ -0,0 +1,116 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+enum class LfoShape
+{
+    sine,
+    triangle,
+    saw,
+    sampleAndHold,
+    smoothRandom
+};
+
+// Low-frequency oscillator counted in cycles of a note value, for modulation at control
+// rate. Each block renders the values at a list of sample offsets (the ends of the control
+// intervals) in one pass over that list, with the shape picked once per block, so the
+// cost depends only on the number of points: never on the rate or the depth.
+//
+// While the host plays, every block takes its starting phase from the host's position,
+// so loops, jumps and tempo changes land on the beat grid exactly. Otherwise the LFO runs
+// on from where the last block ended. The random shapes draw each cycle's value from a
+// hash of the cycle's index rather than a generator's state, so a resync replays the
+// same values at the same position.
+class TempoSyncedLfo
+{
+public:
+    explicit TempoSyncedLfo(juce::uint32 seedToUse = 0) noexcept : seed(seedToUse) {}
+
+    void reset() noexcept { position = 0.0; }
+
+    // Renders values in [-1, 1] at the given offsets into a block of numSamples samples,
+    // then advances past the block. hostPosition is the block's start in cycles, used
+    // when synced.
+    void process(LfoShape shape, double cyclesPerSample, bool synced, double hostPosition,
+                 const float* offsets, float* values, int numPoints, int numSamples) noexcept
+    {
+        if (synced)
+            position = hostPosition;
+
+        // The phase within the block stays small, so float keeps it exact enough even
+        // hours into a session; the whole cycles only matter to the random shapes.
+        const auto startCycle = std::floor(position);
+        const auto startPhase = static_cast<float>(position - startCycle);
+        const auto increment = static_cast<float>(cyclesPerSample);
+        const auto baseCycle = static_cast<juce::int64>(startCycle);
+
+        switch (shape)
+        {
+        case LfoShape::sine:
+            for (int i = 0; i < numPoints; ++i)
+                values[i] = sine(wrap(startPhase + offsets[i] * increment));
+            break;
+
+        case LfoShape::triangle:
+            for (int i = 0; i < numPoints; ++i)
+                values[i] = 1.0f - 4.0f * std::abs(wrap(startPhase + offsets[i] * increment + 0.25f) - 0.5f);
+            break;
+
+        case LfoShape::saw:
+            for (int i = 0; i < numPoints; ++i)
+                values[i] = 2.0f * wrap(startPhase + offsets[i] * increment) - 1.0f;
+            break;
+
+        case LfoShape::sampleAndHold:
+            for (int i = 0; i < numPoints; ++i)
+            {
+                const auto cycles = startPhase + offsets[i] * increment;
+                values[i] = random(baseCycle + static_cast<juce::int64>(std::floor(cycles)));
+            }
+            break;
+
+        case LfoShape::smoothRandom:
+        default:
+            // Smoothstep between one cycle's value and the next: continuous, with no
+            // corners at the cycle boundaries.
+            for (int i = 0; i < numPoints; ++i)
+            {
+                const auto cycles = startPhase + offsets[i] * increment;
+                const auto whole = std::floor(cycles);
+                const auto t = cycles - whole;
+                const auto cycle = baseCycle + static_cast<juce::int64>(whole);
+                const auto from = random(cycle);
+                values[i] = from + (random(cycle + 1) - from) * t * t * (3.0f - 2.0f * t);
+            }
+            break;
+        }
+
+        position += cyclesPerSample * numSamples;
+    }
+
+private:
+    static float wrap(float phase) noexcept { return phase - std::floor(phase); }
+
+    // sin(2 pi phase) from a parabola with one correction term (worst error about 0.001):
+    // branch-free, so the sine pass vectorises like the others.
+    static float sine(float phase) noexcept
+    {
+        const auto x = 2.0f * phase - 1.0f;   // sin(2 pi phase) = -sin(pi x)
+        const auto y = 4.0f * x * (1.0f - std::abs(x));
+        return -(y + 0.225f * (y * std::abs(y) - y));
+    }
+
+    float random(juce::int64 cycle) const noexcept
+    {
+        auto x = static_cast<juce::uint32>(cycle) * 0x9e3779b9u ^ seed;
+        x ^= x >> 16;
+        x *= 0x7feb352du;
+        x ^= x >> 15;
+        x *= 0x846ca68bu;
+        x ^= x >> 16;
+        return static_cast<float>(x) * (2.0f / 4294967296.0f) - 1.0f;
+    }
+
+    juce::uint32 seed;
+    double position{ 0.0 };
+};